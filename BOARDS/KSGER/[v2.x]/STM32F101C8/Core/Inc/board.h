@@ -23,6 +23,10 @@
 //#define USE_RST                                             // Reset pin is used
 //#define USE_DC                                              // DC pin is used
 //#define USE_CS                                              // CS pin is used
+//#define OLED_HORIZONTAL                                     // SSD1306 only, not supported by SH1106. Horizontal addressing, sends the whole frame in a single transfer
+//#define OLED_DOUBLE_BUFFER                                  // Draw while the DMA sends the previous frame (+1KB RAM). Not enough RAM in STM32F101
+//#define GLYPH_CACHE_BYTES   800                             // Cache for the big temperature digits, drawn faster (RAM bytes). Not enough RAM in STM32F101
+//#define OLED_TIM_DMA                                        // Send the SW I2C display in background using TIM2 and DMA1 channel 7. SCL and SDA must be in the same port
 
 
 /********************************
@@ -106,6 +110,7 @@
 #define FLASH_SZ            64                                // Flash Size (KB)
 //#define NOSAVESETTINGS                                      // Don't use flash to save or load settings. Always use defaults (for debugging purposes)
 //#define SWO_PRINT                                           // To enable printing through SWO
+//#define OLED_PROFILE                                        // Print the draw time of each screen through SWO (Needs SWO_PRINT)
 
 
 /********************************
@@ -23,6 +23,9 @@
 #define USE_RST                                               // Reset pin is used
 #define USE_DC                                                // DC pin is used
 #define USE_CS                                                // CS pin is used
+//#define OLED_HORIZONTAL                                     // SSD1306 only, not supported by SH1106. Horizontal addressing, sends the whole frame in a single transfer
+#define OLED_DOUBLE_BUFFER                                    // Draw while the DMA sends the previous frame (+1KB RAM)
+#define GLYPH_CACHE_BYTES   800                               // Cache for the big temperature digits, drawn faster (RAM bytes)
 
 
 /********************************
@@ -98,6 +101,7 @@
 #define FLASH_SZ            64                                // Flash Size (KB)
 //#define NOSAVESETTINGS                                      // Don't use flash to save or load settings. Always use defaults (for debugging purposes)
 //#define SWO_PRINT                                           // To enable printing through SWO
+//#define OLED_PROFILE                                        // Print the draw time of each screen through SWO (Needs SWO_PRINT)
 
 
 /********************************
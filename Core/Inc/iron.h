@@ -67,6 +67,7 @@ typedef struct {
   bool                Cal_TemperatureReachedFlag;           // Flag for temperature calibration
   bool                DebugMode;                            // Flag to indicate Debug is enabled
   bool                updatePwm;                            // Flag to indicate PWM need to be updated
+  uint32_t            FirstPwmTime;                         // Time from power up to the first heating PWM (mS), for boot time measurement
 }iron_t;
 
 
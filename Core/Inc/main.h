@@ -79,6 +79,7 @@ void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
 void Program_Handler(void);
+uint32_t getMicros(void);
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
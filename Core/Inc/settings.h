@@ -13,7 +13,7 @@
 #include "board.h"
 
 #define ProfileSize       3                                         // Number of profiles
-#define TipSize           10                                        // Number of tips for each profile
+#define TipSize           16                                        // Number of tips for each profile. Max 16 (See dirty.tips in settings.c)
 #define TipCharSize       5                                         // String size for each tip name (Including null terminator)
 #define _BLANK_TIP        "    "
 
@@ -35,9 +35,11 @@
 
 //#define SWSTRING        "SW: v1.10"                               // For releases
 #define SWSTRING          "SW: 2021-07-07"                          // For git
-#define SETTINGS_VERSION  5                                         // Change this if you change the struct below to prevent people getting out of sync
-#define StoreSize         2                                         // In KB
-#define FLASH_ADDR        (0x8000000 + ((FLASH_SZ-StoreSize)*1024)) // Last 2KB flash (Minimum erase size, page size=2KB)
+#define SETTINGS_VERSION  6                                         // Change this if you change the struct below to prevent people getting out of sync
+#define StoreSize         4                                         // In KB
+#define SlotSize          2                                         // In KB. Two slots, written alternately (Minimum erase size, page size=2KB)
+#define FLASH_ADDR        (0x8000000 + ((FLASH_SZ-StoreSize)*1024)) // Last 4KB flash
+#define FLASH_ENDURANCE   10000                                     // Minimum erase cycles of each flash page (Datasheet)
 
 enum{
   wakeInputmode_shake     = 0,
@@ -108,6 +110,9 @@ enum{
   output_PWM,
   output_Low,
   output_High,
+
+  slot_Committed          = 0x5AA5,
+  slot_None               = 0xFF,
 };
 
 
@@ -142,8 +147,9 @@ typedef struct{
   uint16_t      Cal250_default;
   uint16_t      Cal350_default;
   uint16_t      Cal450_default;
-  tipData       tip[TipSize];
-}profile_t;
+}profile_t;                                                         // Tips are not kept in RAM, see getTipData()
+
+typedef void (*tipAccess_t)(uint8_t tip, tipData *data);            // Reads or receives the data of a tip
 
 typedef struct{
   uint8_t       NotInitialized;                                     // Always 1 if flash is erased
@@ -178,23 +184,71 @@ typedef __attribute__((aligned(4)))  struct{
   bool          isSaving;
 }systemSettings_t;
 
+// Each slot starts with this header. The commit mark is written last, after verifying the data,
+// so a save interrupted by a power loss leaves the slot uncommitted and the previous slot is used.
+typedef struct{
+  uint16_t      commit;                                             // slot_Committed when the data is complete
+  uint16_t      length;                                             // Stored data length
+  uint32_t      sequence;                                           // Increased in each save, the highest one is the newest slot
+  uint32_t      checksum;                                           // Checksum of the stored data
+}slotHeader_t;
+
+// Stored data header, followed by the encoded profiles (See settings_codec.c)
 typedef __attribute__((aligned(4)))  struct{
-  profile_t     Profile[ProfileSize];
-  uint32_t      ProfileChecksum[ProfileSize];
   settings_t    settings;
   uint32_t      settingsChecksum;
+  uint32_t      ProfileChecksum[ProfileSize];                       // Checksum of the decoded profile
+  uint16_t      ProfileOffset[ProfileSize];                         // Position of the encoded profile from the start of the data, 0xFFFF if not stored
+  uint16_t      ProfileLength[ProfileSize];
 }flashSettings_t;
 
+typedef enum{
+  flash_Idle,
+  flash_Erase,
+  flash_Program,
+  flash_Verify,
+  flash_Commit,
+}flashState_t;
+
+typedef struct{
+  uint32_t      saves;                                              // Completed saves
+  uint32_t      erases;                                             // Erased pages
+  uint32_t      bytesWritten;
+  uint32_t      lastSaveTime;                                       // Time from the start of the save until it was committed, in mS
+  uint32_t      maxSaveTime;
+  uint16_t      lastStall;                                          // Time the CPU was stalled by the last flash operation, in read timer ticks (5uS)
+  uint16_t      maxStall;                                           // Longest stall
+  uint16_t      overruns;                                           // Flash operations that didn't fit in the PWM window
+  uint16_t      skippedReads;                                       // ADC readings skipped by blocking saves (Iron not regulating)
+}flashStats_t;
+
 extern systemSettings_t systemSettings;
 extern flashSettings_t* flashSettings;
+extern flashStats_t flashStats;
+
+// All writes to settings/profile data must use these, so checkSettings knows what to check
+#define setSettingsValue(field, value)    do{ systemSettings.settings.field = (value); setSettingsDirty(); }while(0)
+#define setProfileValue(field, value)     do{ systemSettings.Profile.field = (value); setProfileDirty(); }while(0)
 
 void Diag_init(void);
 void checkSettings(void);
 void saveSettingsFromMenu(uint8_t mode);
 void saveSettings(uint8_t mode);
+void finishSaving(void);
+uint32_t getFlashSaveCount(void);
+uint32_t getFlashSavesLeft(void);
 void restoreSettings();
+uint32_t ChecksumBlock(void* data, uint32_t size);
 uint32_t ChecksumSettings(settings_t* settings);
-uint32_t ChecksumProfile(profile_t* profile);
+uint32_t ChecksumProfile(profile_t* profile, tipAccess_t getTip);
+void setSettingsDirty(void);
+void setProfileDirty(void);
+void setTipDirty(uint8_t tip);
+void getTipData(uint8_t tip, tipData *data);
+char *getProfileTipName(uint8_t tip);
+void setTipData(uint8_t tip, tipData *data);
+void deleteTip(uint8_t tip);
+tipData *selectTip(uint8_t tip);
 void resetSystemSettings(void);
 void resetCurrentProfile(void);
 void storeTipData(uint8_t tip);
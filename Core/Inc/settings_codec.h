@@ -0,0 +1,42 @@
+/*
+ * settings_codec.h
+ *
+ *  Created on: Jul 12, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#ifndef SETTINGS_CODEC_H_
+#define SETTINGS_CODEC_H_
+
+#include "settings.h"
+
+#define ENCODED_TIP_MAX       (TipCharSize + (3*3) + (6*3))        // Name + 3 calibration deltas + 6 PID deltas, up to 3 bytes each
+#define ENCODED_HEADER_MAX    ((11*2) + (11*3))                    // Profile data: 11 8-bit values (2 bytes max), 11 16-bit values (3 bytes max)
+#define ENCODED_PROFILE_MAX   (ENCODED_HEADER_MAX + (TipSize*ENCODED_TIP_MAX))
+#define ENCODED_RECORD_MAX    ((ENCODED_HEADER_MAX>ENCODED_TIP_MAX) ? ENCODED_HEADER_MAX : ENCODED_TIP_MAX)
+
+// Position after the last decoded tip. Set src to NULL when the data it points to changes
+typedef struct{
+  const uint8_t *src;                                               // Profile data, NULL if not valid
+  uint16_t      length;
+  uint16_t      offset;                                             // Position of the next tip
+  uint8_t       next;                                               // Next tip
+  uint8_t       tips;                                               // Tips stored in the profile
+  uint16_t      cal[3];                                             // Profile default calibration, the tips store the difference
+  pid_values_t  prev;                                               // PID of the previous tip, the next one stores the difference
+}tipCursor_t;
+
+// Tips left to encode after the profile data
+typedef struct{
+  uint8_t       next;                                               // Next tip
+  uint8_t       tips;                                               // Tips to encode
+  uint16_t      cal[3];                                             // Profile default calibration, the tips store the difference
+  pid_values_t  prev;                                               // PID of the previous tip, the next one stores the difference
+}tipEncoder_t;
+
+uint8_t encodeProfileHeader(const profile_t *profile, tipEncoder_t *enc, uint8_t *dst);
+uint8_t encodeNextTip(tipEncoder_t *enc, const tipData *tip, uint8_t *dst);
+bool decodeProfile(const uint8_t *src, uint16_t length, profile_t *profile, tipAccess_t putTip);
+bool decodeTip(tipCursor_t *cursor, const uint8_t *src, uint16_t length, uint8_t tip, tipData *dst);
+
+#endif /* SETTINGS_CODEC_H_ */
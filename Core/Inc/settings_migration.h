@@ -0,0 +1,55 @@
+/*
+ * settings_migration.h
+ *
+ *  Created on: Jul 10, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#ifndef SETTINGS_MIGRATION_H_
+#define SETTINGS_MIGRATION_H_
+
+#include "settings.h"
+
+enum{
+  field_Unsigned          = 0,
+  field_Signed            = 1,
+
+  checksum_Words          = 0,                                      // HAL CRC over the whole words of the record (v5)
+};
+
+// Describes where a field was stored in a previous version
+typedef struct{
+  uint8_t       id;                                                 // Field identifier, same in all the versions
+  uint8_t       offset;
+  uint8_t       size;
+  uint8_t       flags;
+  void          (*convert)(const uint8_t *src, void *dst);          // Optional, if the field changed its meaning. Otherwise it's just copied
+}schemaField_t;
+
+// Describes the flash layout of a settings version
+typedef struct{
+  uint32_t              version;
+  uint8_t               checksum;                                   // Checksum type
+  uint8_t               tips;                                       // Tips per profile
+  uint16_t              profileSize;
+  uint16_t              tipOffset;                                  // Tip array position inside the profile
+  uint16_t              tipSize;
+  uint16_t              profileChecksumOffset;                      // Profile checksum array position in the flash
+  uint16_t              settingsOffset;
+  uint16_t              settingsSize;
+  uint16_t              settingsChecksumOffset;
+  uint16_t              versionOffset;                              // Version position inside the settings
+  const schemaField_t   *settingsFields;
+  const schemaField_t   *profileFields;
+  const schemaField_t   *tipFields;
+  uint8_t               settingsFieldCount;
+  uint8_t               profileFieldCount;
+  uint8_t               tipFieldCount;
+}schema_t;
+
+uint32_t getStoredVersion(void);
+bool migrateSettings(uint32_t version, settings_t *dst);
+bool migrateProfile(uint32_t version, uint8_t profile, profile_t *dst);
+bool migrateTip(uint32_t version, uint8_t profile, uint8_t tip, tipData *dst);
+
+#endif /* SETTINGS_MIGRATION_H_ */
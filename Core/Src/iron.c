@@ -161,6 +161,9 @@ void handleIron(void) {
     __HAL_TIM_SET_AUTORELOAD(Iron.Pwm_Timer, Iron.Pwm_Period);
   }
   __HAL_TIM_SET_COMPARE(Iron.Pwm_Timer, Iron.Pwm_Channel, Iron.Pwm_Out);                      // Load new calculated PWM Duty
+  if(Iron.Pwm_Out && !Iron.FirstPwmTime){
+    Iron.FirstPwmTime = HAL_GetTick();
+  }
 
   // For calibration process. Add +-2ºC detection margin
   if(  (tipTemp>=(Iron.CurrentSetTemperature-2)) && (tipTemp<=(Iron.CurrentSetTemperature+2)) && !Iron.Cal_TemperatureReachedFlag) {
@@ -184,14 +187,14 @@ uint16_t round_10(uint16_t input){
 void setSystemTempUnit(bool unit){
 
   if(systemSettings.Profile.tempUnit != unit){
-    systemSettings.Profile.tempUnit = unit;
-    systemSettings.Profile.UserSetTemperature = round_10(TempConversion(systemSettings.Profile.UserSetTemperature,unit,0));
-    systemSettings.Profile.standbyTemperature = round_10(TempConversion(systemSettings.Profile.standbyTemperature,unit,0));
-    systemSettings.Profile.MaxSetTemperature = round_10(TempConversion(systemSettings.Profile.MaxSetTemperature,unit,0));
-    systemSettings.Profile.MinSetTemperature = round_10(TempConversion(systemSettings.Profile.MinSetTemperature,unit,0));
+    setProfileValue(tempUnit, unit);
+    setProfileValue(UserSetTemperature, round_10(TempConversion(systemSettings.Profile.UserSetTemperature,unit,0)));
+    setProfileValue(standbyTemperature, round_10(TempConversion(systemSettings.Profile.standbyTemperature,unit,0)));
+    setProfileValue(MaxSetTemperature, round_10(TempConversion(systemSettings.Profile.MaxSetTemperature,unit,0)));
+    setProfileValue(MinSetTemperature, round_10(TempConversion(systemSettings.Profile.MinSetTemperature,unit,0)));
   }
 
-  systemSettings.settings.tempUnit = unit;
+  setSettingsValue(tempUnit, unit);
   setCurrentMode(Iron.CurrentMode);     // Reload temps
 }
 
@@ -243,17 +246,17 @@ void initTimers(void){
 }
 
 void setReadDelay(uint16_t delay){
- systemSettings.Profile.readDelay=delay;
+ setProfileValue(readDelay, delay);
 }
 
 
 void setReadPeriod(uint16_t period){
- systemSettings.Profile.readPeriod=period;
+ setProfileValue(readPeriod, period);
  Iron.updatePwm=1;
 }
 
 void setPwmMul(uint16_t mult){
-  systemSettings.Profile.pwmMul=mult;
+  setProfileValue(pwmMul, mult);
   Iron.updatePwm=1;
 }
 
@@ -394,7 +397,7 @@ void updatePowerLimit(void){
 
 // Sets no Iron detection threshold
 void setNoIronValue(uint16_t noiron){
-  systemSettings.Profile.noIronValue=noiron;
+  setProfileValue(noIronValue, noiron);
 }
 
 // Change the iron operating mode in stand mode
@@ -527,7 +530,7 @@ void setDebugMode(uint8_t value) {
 void setUserTemperature(uint16_t temperature) {
   Iron.Cal_TemperatureReachedFlag = 0;
   if(systemSettings.Profile.UserSetTemperature != temperature){
-    systemSettings.Profile.UserSetTemperature = temperature;
+    setProfileValue(UserSetTemperature, temperature);
     if(Iron.CurrentMode==mode_run){
       Iron.CurrentSetTemperature=temperature;
       resetPID();
@@ -65,7 +65,7 @@ volatile bool dbg_newData;
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
-#if defined DEBUG_PWM && defined SWO_PRINT
+#ifdef SWO_PRINT
 int _write(int32_t file, uint8_t *ptr, int32_t len)
 {
   for (int i = 0; i < len; i++)
@@ -76,6 +76,16 @@ int _write(int32_t file, uint8_t *ptr, int32_t len)
 }
 #endif
 
+// Time in uS, using the systick counter for the sub-mS part. Rolls over every ~71 minutes, only for measuring short times
+uint32_t getMicros(void){
+  uint32_t tick, val;
+  do{
+    tick = HAL_GetTick();
+    val = SysTick->VAL;
+  }while(tick!=HAL_GetTick());                                            // Systick rolled over while reading
+  return (tick*1000) + (((SysTick->LOAD-val)*1000)/(SysTick->LOAD+1));
+}
+
 void Init(void){
 #if (defined OLED_SPI || defined OLED_I2C) && defined OLED_DEVICE
   ssd1306_init(&OLED_DEVICE, &FILL_DMA);
@@ -87,7 +97,10 @@ void Init(void){
     ADC_Init(&ADC_DEVICE);
     buzzer_init();
     restoreSettings();
-    ironInit(&READ_TIMER, &PWM_TIMER,PWM_CHANNEL);
+    ironInit(&READ_TIMER, &PWM_TIMER,PWM_CHANNEL);       // Start the control loop first, the iron heats while the display is starting
+#if defined OLED_SPI || defined OLED_I2C
+    ssd1306_start();
+#endif
     RE_Init((RE_State_t *)&RE1_Data, ENC_L_GPIO_Port, ENC_L_Pin, ENC_R_GPIO_Port, ENC_R_Pin, ENC_SW_GPIO_Port, ENC_SW_Pin);
     oled_init(&RE_Get,&RE1_Data);
 }
@@ -230,6 +243,8 @@ void Error_Handler(void)
   if(!oled.use_sw){
     display_abort();
   }
+  #elif defined OLED_TIM_DMA
+  display_abort();
   #endif
   setSafeMode(enable);
   buzzer_fatal_beep();
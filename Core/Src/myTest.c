@@ -12,78 +12,160 @@
 #include "iron.h"
 #include "ssd1306.h"
 #include "gui.h"
+#include "main_screen.h"
 
-struct{
-  uint32_t tim_fps, tim_move;
-  uint16_t fps,last_fps, rate, seconds;
-  int8_t rad,x,y,xdir,ydir,run;
-}test;
+// Display benchmark. Runs each scenario for BENCH_TIME mS, then shows the results, one scenario per page. Repeats forever.
+// Compare the transports (SW/HW, OLED_DOUBLE_BUFFER, OLED_HORIZONTAL, OLED_TIM_DMA...) and the boards with the same numbers.
+//  FPS:  Frames sent to the display per second.
+//  R:    CPU time drawing the frame (uS per frame).
+//  T:    CPU time in the transport (uS per frame). Sending in software mode, copying the buffer or waiting for the display in DMA mode.
+//  B/F:  Bytes sent per frame, including the position commands.
+// With SWO_PRINT, the results are also printed through SWO.
+#define BENCH_TIME          2000
+#define BENCH_PAGE_TIME     2500
 
+typedef struct{
+  const char *name;
+  void (*draw)(uint16_t frame);
+}bench_t;
 
-// This is just a test that draws a bouncing ball and updates the screen as fast as possible
-// To measure display performance
-void myTest(void){
-  test.tim_fps = test.tim_move = HAL_GetTick();
-  test.rad=12;
-  test.x=63+32;
-  test.y=test.rad+1;
-  test.xdir=1;
-  test.ydir=1;
-  test.rate=20;
-
-  //#ifndef DEBUG
-  test.run=1;
-  //#endif
-
-  char str[16];
-  setContrast(255);
+typedef struct{
+  uint32_t frames, sent, bytes, time, render, transport;
+}benchResult_t;
+
+static const char * const menuItems[] = { "PROFILE", "TIP", "CALIBRATION", "CONTRAST", "BOOT", "SLEEP", "BUZZER", "WAKE MODE" };
+#define MENU_ITEMS          (sizeof(menuItems)/sizeof(menuItems[0]))
+
+// Whole screen changes every frame
+static void benchClear(uint16_t frame){
+  FillBuffer(frame&1 ? WHITE : BLACK, fill_dma);
+}
+
+// Settings menu, scrolling one item per frame
+static void benchMenu(uint16_t frame){
   FillBuffer(BLACK, fill_dma);
-  u8g2_SetFont(&u8g2,default_font );
+  u8g2_SetFont(&u8g2, default_font);
+  for(uint8_t x=0; x<4; x++){
+    u8g2_SetDrawColor(&u8g2, WHITE);
+    if(x==(frame&3)){
+      u8g2_DrawBox(&u8g2, 0, x*16, OledWidth, 16);                        // Selected item
+      u8g2_SetDrawColor(&u8g2, BLACK);
+    }
+    u8g2_DrawStr(&u8g2, 2, x*16, menuItems[(frame/4+x)%MENU_ITEMS]);
+    u8g2_DrawStr(&u8g2, 118, x*16, ">");
+  }
   u8g2_SetDrawColor(&u8g2, WHITE);
+}
+
+// Main screen, drawn by main_screen.c with fixed readings. The big temperature changes every 8 frames
+static void benchMain(uint16_t frame){
+  main_screen_bench(frame, 0);
+}
+
+// Main screen with the temperature graph, one new sample per frame
+static void benchGraph(uint16_t frame){
+  main_screen_bench(frame, 1);
+}
+
+// Static screen, only one digit changes
+static void benchDigit(uint16_t frame){
+  char str[2] = { '0'+(frame%10), 0 };
+  u8g2_SetFont(&u8g2, default_font);
+  if(!frame){
+    FillBuffer(BLACK, fill_dma);
+    u8g2_DrawStr(&u8g2, 0, 0, "STATIC SCREEN");
+    u8g2_DrawStr(&u8g2, 0, 24, "VALUE:");
+    u8g2_DrawFrame(&u8g2, 0, 44, OledWidth, 20);
+  }
+  u8g2_SetDrawColor(&u8g2, BLACK);
+  u8g2_DrawBox(&u8g2, 64, 24, 12, 16);
+  u8g2_SetDrawColor(&u8g2, WHITE);
+  u8g2_DrawStr(&u8g2, 64, 24, str);
+}
+
+static const bench_t benchList[] = {
+    { "CLEAR", benchClear },
+    { "MENU",  benchMenu },
+    { "MAIN",  benchMain },
+    { "GRAPH", benchGraph },
+    { "DIGIT", benchDigit },
+};
+#define BENCH_COUNT         (sizeof(benchList)/sizeof(benchList[0]))
+
+static void benchRun(const bench_t *bench, benchResult_t *result){
+  uint32_t frames=oled.frames, bytes=oled.bytes;
+  uint32_t start=HAL_GetTick();
+
+  memset(result, 0, sizeof(benchResult_t));
+  while((HAL_GetTick()-start)<BENCH_TIME){
+    uint32_t t0 = getMicros();
+    while(oledBufferBusy());                                              // Without double buffer, wait until the previous frame is sent
+    uint32_t t1 = getMicros();
+    bench->draw(result->frames);
+    uint32_t t2 = getMicros();
+    while(oled.status!=oled_idle);                                        // With double buffer, the previous frame was sent while drawing
+    update_display();
+    uint32_t t3 = getMicros();
+    result->render += t2-t1;
+    result->transport += (t1-t0)+(t3-t2);
+    result->frames++;
+    HAL_IWDG_Refresh(&hiwdg);
+  }
+  while(oled.status!=oled_idle);                                          // Count the last frame
+  result->time = HAL_GetTick()-start;
+  result->sent = oled.frames-frames;
+  result->bytes = oled.bytes-bytes;
+}
+
+static void benchShow(const bench_t *bench, benchResult_t *result){
+  char str[24];
+  uint32_t fps = (result->sent*1000)/result->time;
+  uint32_t render = result->frames ? result->render/result->frames : 0;
+  uint32_t transport = result->frames ? result->transport/result->frames : 0;
+  uint32_t bpf = result->sent ? result->bytes/result->sent : 0;
+
+  FillBuffer(BLACK, fill_dma);
+  u8g2_SetFont(&u8g2, default_font);
+  u8g2_DrawStr(&u8g2, 0, 0, bench->name);
   if(oled.use_sw){
-    u8g2_DrawStr(&u8g2,0,0,"SW Mode");
+    u8g2_DrawStr(&u8g2, 64, 0, "SW");
   }
   else{
-    u8g2_DrawStr(&u8g2,0,0,"HW Mode");
+#ifdef OLED_DOUBLE_BUFFER
+    u8g2_DrawStr(&u8g2, 64, 0, "HW2x");
+#else
+    u8g2_DrawStr(&u8g2, 64, 0, "HW");
+#endif
   }
-  u8g2_DrawStr(&u8g2,0,48,"FPS:");
-  u8g2_DrawStr(&u8g2,0,32,"TIM:");
+  sprintf(str, "FPS:%lu", fps);
+  u8g2_DrawStr(&u8g2, 0, 16, str);
+  sprintf(str, "R:%lu T:%lu", render, transport);
+  u8g2_DrawStr(&u8g2, 0, 32, str);
+  sprintf(str, "B/F:%lu", bpf);
+  u8g2_DrawStr(&u8g2, 0, 48, str);
+  update_display();
+
+#ifdef SWO_PRINT
+  printf("%-6s %s  FPS:%3lu  Render:%6luuS  Transport:%6luuS  Bytes/frame:%5lu\n", bench->name, oled.use_sw ? "SW" : "HW", fps, render, transport, bpf);
+#endif
+}
+
+void myTest(void){
+  benchResult_t result[BENCH_COUNT];
+
+  setSafeMode(enable);
+  setContrast(255);
+  u8g2_SetDrawColor(&u8g2, WHITE);
   while(1){
-    setSafeMode(enable);
-    if(oled.status==oled_idle){
-      if((HAL_GetTick()-test.tim_fps)>999){
-          test.seconds++;
-          test.tim_fps=HAL_GetTick();
-          u8g2_SetDrawColor(&u8g2, BLACK);
-          u8g2_DrawBox(&u8g2, 30, 16, 34, 48);
-          u8g2_SetDrawColor(&u8g2, WHITE);
-          sprintf(str,"%u", test.fps);
-          u8g2_DrawStr(&u8g2,30,48,str);
-          sprintf(str,"%u", test.seconds);
-          u8g2_DrawStr(&u8g2,30,32,str);
-          test.last_fps = test.fps;
-          test.fps=0;
-      }
-      if((HAL_GetTick()-test.tim_move)>=test.rate){
-        test.tim_move=HAL_GetTick();
-        u8g2_SetDrawColor(&u8g2, BLACK);
-        u8g2_DrawBox(&u8g2, test.x-test.rad, test.y-test.rad, (test.rad*2)+1, (test.rad*2)+1);
-        u8g2_SetDrawColor(&u8g2, WHITE);
-        if(test.run){
-          test.x += test.xdir;
-          test.y += test.ydir;
-          if(test.x>=(127-(test.rad+1)) || test.x<=(64+test.rad+1)){
-            test.xdir = -test.xdir;
-          }
-          if(test.y>=(63-(test.rad+1))|| test.y<=(test.rad+1)){
-            test.ydir = -test.ydir;
-          }
-        }
-        u8g2_DrawDisc(&u8g2, test.x, test.y, test.rad, U8G2_DRAW_ALL);
-        u8g2_DrawFrame(&u8g2, 64, 0, 64, 64);
+    for(uint8_t x=0; x<BENCH_COUNT; x++){
+      benchRun(&benchList[x], &result[x]);
+    }
+    for(uint8_t x=0; x<BENCH_COUNT; x++){
+      while(oled.status!=oled_idle);
+      benchShow(&benchList[x], &result[x]);
+      for(uint32_t t=HAL_GetTick(); (HAL_GetTick()-t)<BENCH_PAGE_TIME; ){
+        HAL_IWDG_Refresh(&hiwdg);
       }
-      test.fps++;
-      update_display();
     }
   }
 }
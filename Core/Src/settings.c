@@ -11,9 +11,107 @@
 #include "gui.h"
 #include "ssd1306.h"
 #include "tempsensors.h"
+#include "settings_migration.h"
+#include "settings_codec.h"
+#include <stddef.h>
+
+#define SLOT_SIZE         (SlotSize*1024)
+#define SLOT_PAGES        (SLOT_SIZE/FLASH_PAGE_SIZE)               // Pages used by each slot
+#define SLOT_DATA_SIZE    (SLOT_SIZE-sizeof(slotHeader_t))
+#define FLASH_ERASE_TICKS (45*200)                                  // Worst case page erase time, in read timer ticks (5uS). Datasheet: 20-40mS
+#define FLASH_PROG_TICKS  (2*200)                                   // Time reserved for one programming burst (2mS)
+#define FLASH_PROG_BURST  16                                        // Halfwords programmed per burst (~70uS each, worst case)
+#define FLASH_IMAGE_SIZE  (sizeof(slotHeader_t)+sizeof(flashSettings_t)+(ProfileSize*(ENCODED_PROFILE_MAX+1)))     // Worst case size of the stored data (Profiles are halfword aligned)
+#define BLOCK_HEADER      ProfileSize                               // Blocks written in each save: profiles, settings header, slot header
+#define BLOCK_SLOT        (ProfileSize+1)
+
+_Static_assert(FLASH_IMAGE_SIZE <= SLOT_SIZE, "Settings don't fit in the flash slot");
+_Static_assert((2*SlotSize) == StoreSize, "The flash storage must have two slots");
 
 systemSettings_t systemSettings;
-flashSettings_t* flashSettings = (flashSettings_t*)FLASH_ADDR;
+flashSettings_t* flashSettings = (flashSettings_t*)(FLASH_ADDR+sizeof(slotHeader_t));   // Data in the active slot
+flashStats_t flashStats;
+
+enum{
+  tip_None                = 0xFF,
+};
+
+enum{
+  window_Wait,                                                      // Not enough time left in this period, retry in the next one
+  window_Ready,                                                     // Fits before the next reading
+  window_StopIron,                                                  // The period is too short for the operation, stop the iron while doing it
+};
+
+enum{
+  source_None,                                                      // Profile not stored
+  source_Flash,                                                     // Copied from the active slot
+  source_Encode,                                                    // Encoded from RAM when it's going to be written
+};
+
+static uint8_t activeSlot = slot_None;                                                 // Newest complete slot
+static uint8_t recordBuffer[ENCODED_RECORD_MAX+1] __attribute__((aligned(4)));          // Encoded record being written, after the odd byte left by the previous one
+static flashSettings_t writerHeader;                                                    // Settings header being written
+static slotHeader_t writerSlot;
+static struct{
+  flashState_t  state;
+  uint8_t       slot;                                               // Slot being written, never the active one
+  uint8_t       page;
+  uint8_t       block;                                              // Block being written
+  uint8_t       source[ProfileSize];
+  uint16_t      (*encode)(uint8_t profile);                         // Encodes the profile data into recordBuffer and sets getTip, returns the length
+  tipAccess_t   getTip;                                             // Tips of the profile being encoded
+  tipEncoder_t  tips;                                               // Tips left to encode in the current block
+  tipData       currentTip;                                         // Current tip when the profile was encoded, it can change while saving
+  const uint8_t *src;                                               // Current block data, or the current record for the encoded profiles
+  uint16_t      dest;                                               // Position of src in the slot
+  uint16_t      size;                                               // Bytes in src
+  uint16_t      written;                                            // Bytes of src already written
+  uint16_t      length;                                             // Data length, excluding the slot header
+  uint32_t      startTime;
+}flashWriter;
+
+static struct{
+  volatile uint8_t    settings;
+  volatile uint8_t    profile;                                      // Profile data, excluding the tips
+  volatile uint16_t   tips;                                         // One bit per tip
+  volatile uint32_t   lastChange;
+}dirty;
+
+_Static_assert(TipSize <= 16, "dirty.tips has one bit per tip, widen it to use more tips");
+
+static uint32_t settingsCRC;                                        // Last computed checksums for the data in RAM
+static uint32_t profileCRC[TipSize+1];                              // [0] Profile data, [1..TipSize] tips
+
+// Tips of the current profile. Only the names and the current tip are kept in RAM, the rest are decoded from the flash when needed.
+// A modified tip is copied to an overlay until the next save (Copy-on-write), so they're stored by the background save.
+// If all the overlays are used and another tip is modified, the profile is saved first.
+#define TIP_OVERLAYS      2
+
+static struct{
+  tipData       ram[TIP_OVERLAYS+1];                                // [0] Current tip, used by the iron. [1..] Overlays
+  uint8_t       current;                                            // Tip in ram[0]
+  uint8_t       overlay[TIP_OVERLAYS];                              // Tip in ram[x+1], tip_None if not used
+  uint8_t       position[TipSize];                                  // Position of each tip in the stored profile
+  bool          stored;                                             // The stored profile matches the one in RAM, otherwise the tips use the default values
+  char          name[TipSize][TipCharSize];
+}tipTable;
+static tipCursor_t tipCursor;                                       // Last tip decoded from the active slot
+
+static const pid_values_t defaultPID[ProfileSize] = {
+  [profile_T12]  = { .Kp = 7500, .Ki = 4000, .Kd = 1000, .tau = 10, .maxI = 40, .minI = 0 },     // Kp, Ki, Kd = /1.000.000, tau, maxI, minI = /100
+  [profile_C245] = { .Kp = 1800, .Ki = 500,  .Kd = 200,  .tau = 10, .maxI = 10, .minI = 0 },
+  [profile_C210] = { .Kp = 1800, .Ki = 500,  .Kd = 200,  .tau = 10, .maxI = 10, .minI = 0 },
+};
+
+static void startSaving(uint8_t mode);
+static void writeFlash(void);
+static void flashWriterStep(bool blocking);
+static bool migrateFlash(uint32_t version);
+static bool isFlashValid(void);
+static void findActiveSlot(void);
+static bool getStoredProfile(uint8_t profile, const uint8_t **data, uint16_t *length);
+static uint16_t encodeCurrentProfile(uint8_t profile);
+static void setTipsStored(void);
 void settingsChkErr(void);
 void ProfileChkErr(void);
 void Flash_error(void);
@@ -25,14 +123,22 @@ void ErrCountDown(uint8_t Start,uint8_t xpos, uint8_t ypos);
 
 void checkSettings(void){
 
-  static uint32_t prevSysChecksum=0, newSysChecksum=0, prevTipChecksum=0, newTipChecksum=0, lastCheckTime=0, lastChangeTime=0;
   uint32_t CurrentTime = HAL_GetTick();
 
+  // Background save in progress
+  if(flashWriter.state!=flash_Idle){
+    if(systemSettings.save_Flag<=save_Settings){                                                                          // Nothing urgent, keep writing in the background
+      flashWriterStep(0);
+      return;
+    }
+    finishSaving();                                                                                                         // Reset requested, complete the current save first
+  }
+
   // Save from menu
   if(systemSettings.save_Flag){
     switch(systemSettings.save_Flag){
       case save_Settings:
-        saveSettings(keepProfiles);
+        startSaving(keepProfiles);
         break;
       case reset_Settings:
       {
@@ -67,28 +173,301 @@ void checkSettings(void){
   }
 
   // Auto save on content change
-  if( (systemSettings.setupMode==setup_On) || (Iron.calibrating==calibration_On) || (systemSettings.settings.saveSettingsDelay==0) || (Iron.Error.safeMode==enable) || (CurrentTime-lastCheckTime<999)){
+  if(!dirty.settings && !dirty.profile && !dirty.tips){                                                                     // Nothing changed
+    return;
+  }
+  if( (systemSettings.setupMode==setup_On) || (Iron.calibrating==calibration_On) || (systemSettings.settings.saveSettingsDelay==0) || (Iron.Error.safeMode==enable)){
+    return;
+  }
+  if((CurrentTime-dirty.lastChange)<((uint32_t)systemSettings.settings.saveSettingsDelay*1000)){                           // Settings are being changed, wait until there are no changes for enough time
     return;
   }
 
-  lastCheckTime = CurrentTime;                                                                                              // Store current time
-  newSysChecksum = ChecksumSettings(&systemSettings.settings);                                                              // Calculate system checksum
-  newTipChecksum = ChecksumProfile(&systemSettings.Profile);                                                                // Calculate tip profile checksum
-
-  if((systemSettings.settingsChecksum != newSysChecksum) || (systemSettings.ProfileChecksum != newTipChecksum)){            // If anything was changed (Checksum mismatch)
+  __disable_irq();
+  uint8_t settings = dirty.settings;
+  uint8_t profile = dirty.profile;
+  uint16_t tips = dirty.tips;
+  dirty.settings = 0;
+  dirty.profile = 0;
+  dirty.tips = 0;
+  __enable_irq();
 
-    if((prevSysChecksum != newSysChecksum) || (prevTipChecksum != newTipChecksum)){                                         // If different from the previous calculated checksum (settings are being changed quickly, don't save every time).
-      prevSysChecksum = newSysChecksum;                                                                                     // Store last computed checksum
-      prevTipChecksum = newTipChecksum;
-      lastChangeTime = CurrentTime;                                                                                         // Reset timer (we don't save anything until we pass a certain time without changes)
+  if(settings){                                                                                                             // Only compute the checksum of the changed data
+    settingsCRC = ChecksumSettings(&systemSettings.settings);
+  }
+  if(profile){
+    profileCRC[0] = ChecksumBlock(&systemSettings.Profile, sizeof(profile_t));
+  }
+  for(uint8_t x=0; tips; x++, tips>>=1){
+    if(tips&1){
+      tipData tip;
+      getTipData(x, &tip);
+      profileCRC[x+1] = ChecksumBlock(&tip, sizeof(tipData));
     }
+  }
+
+  if( (settingsCRC != systemSettings.settingsChecksum) ||
+      (HAL_CRC_Calculate(&hcrc, profileCRC, TipSize+1) != systemSettings.ProfileChecksum) ){                                // If anything was changed (Checksum mismatch)
+    startSaving(keepProfiles);                                                                                              // Start saving in the background
+  }
+}
+
+void setSettingsDirty(void){
+  dirty.settings = 1;
+  dirty.lastChange = HAL_GetTick();
+}
+
+void setProfileDirty(void){
+  dirty.profile = 1;
+  dirty.lastChange = HAL_GetTick();
+}
+
+void setTipDirty(uint8_t tip){
+  if(tip<TipSize){
+    dirty.tips |= 1<<tip;
+    dirty.lastChange = HAL_GetTick();
+  }
+}
+
+// Copy the tip data. Padding is cleared, so the checksum only depends on the data
+static void copyTip(tipData *dst, const tipData *src){
+  memset(dst, 0, sizeof(tipData));
+  dst->calADC_At_250 = src->calADC_At_250;
+  dst->calADC_At_350 = src->calADC_At_350;
+  dst->calADC_At_450 = src->calADC_At_450;
+  memcpy(dst->name, src->name, TipCharSize);
+  dst->PID = src->PID;
+}
+
+static void getBlankTip(tipData *tip){
+  memset(tip, 0, sizeof(tipData));
+  strcpy(tip->name, _BLANK_TIP);
+}
+
+static void getDefaultTip(tipData *tip){
+  getBlankTip(tip);
+  tip->calADC_At_250 = systemSettings.Profile.Cal250_default;
+  tip->calADC_At_350 = systemSettings.Profile.Cal350_default;
+  tip->calADC_At_450 = systemSettings.Profile.Cal450_default;
+  if(systemSettings.Profile.ID<ProfileSize){
+    tip->PID = defaultPID[systemSettings.Profile.ID];
+  }
+}
+
+// Read the tip from the stored profile, or the default values if the profile is not stored
+static void getStoredTip(uint8_t position, tipData *tip){
+  const uint8_t *data;
+  uint16_t length;
+
+  if(!tipTable.stored || !getStoredProfile(systemSettings.Profile.ID, &data, &length) || !decodeTip(&tipCursor, data, length, position, tip)){
+    getDefaultTip(tip);
+  }
+}
+
+// Overlay holding the tip, TIP_OVERLAYS if not found
+static uint8_t findOverlay(uint8_t tip){
+  uint8_t x;
+
+  for(x=0; (x<TIP_OVERLAYS) && (tipTable.overlay[x]!=tip); x++);
+  return x;
+}
+
+// Get a copy of the tip data. Unused tips are blank
+void getTipData(uint8_t tip, tipData *data){
+  tipData stored;
+  uint8_t overlay = findOverlay(tip);
+
+  if(tip>=systemSettings.Profile.currentNumberOfTips || tip>=TipSize){
+    getBlankTip(data);
+    return;
+  }
+  if(tip==tipTable.current){
+    copyTip(data, &tipTable.ram[0]);
+  }
+  else if(overlay<TIP_OVERLAYS){
+    copyTip(data, &tipTable.ram[overlay+1]);
+  }
+  else{
+    getStoredTip(tipTable.position[tip], &stored);
+    copyTip(data, &stored);
+  }
+  memcpy(data->name, tipTable.name[tip], TipCharSize);                              // Names are always in RAM
+}
 
-    else if((CurrentTime-lastChangeTime)>((uint32_t)systemSettings.settings.saveSettingsDelay*1000)){                       // If different from the previous calculated checksum, and timer expired (No changes for enough time)
-      saveSettings(save_Settings);                                                                                          // Data was saved (so any pending interrupt knows this)
+// Tip name in RAM, the pointer is always valid (Contents change if the tips are modified)
+char *getProfileTipName(uint8_t tip){
+  if(tip>=TipSize){
+    Error_Handler();
+  }
+  return tipTable.name[tip];
+}
+
+// Check if the tip data in RAM is the same as the stored one
+static bool isTipStored(uint8_t tip, tipData *data){
+  tipData stored, ram;
+
+  getStoredTip(tipTable.position[tip], &stored);
+  copyTip(&ram, data);
+  memcpy(stored.name, ram.name, TipCharSize);                                   // Names are kept in RAM, only compare the data
+  return !memcmp(&stored, &ram, sizeof(tipData));
+}
+
+// Save the profile so the modified tips are stored and the overlays can be reused.
+// Iron keeps running. The profile isn't stored until it's configured (profile_None), the overlays are just replaced.
+static void saveTips(void){
+  finishSaving();
+  if(systemSettings.settings.currentProfile<=profile_C210){
+    startSaving(keepProfiles);
+    finishSaving();
+  }
+  memset(tipTable.overlay, tip_None, TIP_OVERLAYS);
+}
+
+// Keep the modified tip in an overlay until the next save. Only saves now if all of them are used by other tips
+static void putOverlay(uint8_t tip, tipData *data){
+  uint8_t x = findOverlay(tip);
+
+  if(x==TIP_OVERLAYS){
+    x = findOverlay(tip_None);
+  }
+  if(x==TIP_OVERLAYS){
+    saveTips();
+    x = 0;
+  }
+  copyTip(&tipTable.ram[x+1], data);
+  tipTable.overlay[x] = tip;
+}
+
+// Called when the profile in RAM was stored, all the tips are now in the flash in the same order
+static void setTipsStored(void){
+  for(uint8_t x=0; x<TipSize; x++){
+    tipTable.position[x] = x;
+  }
+  memset(tipTable.overlay, tip_None, TIP_OVERLAYS);
+  tipTable.stored = 1;
+}
+
+// Reset the tip table to the profile defaults
+static void resetTips(const char *name){
+  for(uint8_t x=0; x<TipSize; x++){
+    strcpy(tipTable.name[x], _BLANK_TIP);
+  }
+  strcpy(tipTable.name[0], name);
+  setTipsStored();
+  tipTable.stored = 0;
+  tipTable.current = 0;
+  getDefaultTip(&tipTable.ram[0]);
+  memcpy(tipTable.ram[0].name, tipTable.name[0], TipCharSize);
+}
+
+// Used while decoding the stored profile
+static void loadTip(uint8_t tip, tipData *data){
+  memcpy(tipTable.name[tip], data->name, TipCharSize);
+  if(tip==systemSettings.Profile.currentTip){
+    copyTip(&tipTable.ram[0], data);
+  }
+}
+
+void setTipData(uint8_t tip, tipData *data){
+  if(tip>=TipSize){
+    return;
+  }
+  if(tip==tipTable.current){
+    __disable_irq();
+    copyTip(&tipTable.ram[0], data);
+    __enable_irq();
+  }
+  else{
+    finishSaving();                                                             // The tip table can't change while saving
+    putOverlay(tip, data);
+  }
+  memcpy(tipTable.name[tip], data->name, TipCharSize);
+  setTipDirty(tip);
+}
+
+// Remove the tip, moving the rest one position backwards
+void deleteTip(uint8_t tip){
+  uint8_t tipCount = systemSettings.Profile.currentNumberOfTips;
+  bool reload = 0;
+
+  if(tip>=tipCount || tipCount<2){
+    return;
+  }
+  finishSaving();
+  __disable_irq();
+  for(uint8_t x=tip; x<TipSize-1; x++){
+    tipTable.position[x] = tipTable.position[x+1];
+    memcpy(tipTable.name[x], tipTable.name[x+1], TipCharSize);
+    setTipDirty(x);
+  }
+  strcpy(tipTable.name[TipSize-1], _BLANK_TIP);
+  setTipDirty(TipSize-1);
+
+  for(uint8_t x=0; x<TIP_OVERLAYS; x++){
+    if(tipTable.overlay[x]==tip){
+      tipTable.overlay[x] = tip_None;
     }
+    else if(tipTable.overlay[x]!=tip_None && tipTable.overlay[x]>tip){
+      tipTable.overlay[x]--;
+    }
+  }
+  if(tipTable.current==tip){                                                        // Current tip deleted, use the next one (Or the previous if it was the last)
+    tipTable.current = tip_None;
+    reload = 1;
+  }
+  else if(tipTable.current>tip){
+    tipTable.current--;
+  }
+  setProfileValue(currentNumberOfTips, tipCount-1);
+  __enable_irq();
+
+  if(reload){
+    setProfileValue(currentTip, (tip<tipCount-1) ? tip : tipCount-2);
+    setCurrentTip(systemSettings.Profile.currentTip);
+  }
+  else{
+    setProfileValue(currentTip, tipTable.current);
   }
 }
 
+// Make the tip the current one, loading it into RAM. Returns the data used by the iron
+tipData *selectTip(uint8_t tip){
+  tipData data;
+  uint8_t overlay;
+
+  if(tip>=TipSize){
+    Error_Handler();
+  }
+  if(tip==tipTable.current){
+    return &tipTable.ram[0];
+  }
+  finishSaving();
+  if( (tipTable.current!=tip_None) && !isTipStored(tipTable.current, &tipTable.ram[0]) ){  // Keep the changes of the previous tip
+    putOverlay(tipTable.current, &tipTable.ram[0]);
+  }
+  overlay = findOverlay(tip);
+  if(overlay<TIP_OVERLAYS){
+    copyTip(&data, &tipTable.ram[overlay+1]);
+    tipTable.overlay[overlay] = tip_None;
+  }
+  else{
+    getStoredTip(tipTable.position[tip], &data);
+  }
+  memcpy(data.name, tipTable.name[tip], TipCharSize);
+  __disable_irq();
+  copyTip(&tipTable.ram[0], &data);
+  tipTable.current = tip;
+  __enable_irq();
+  return &tipTable.ram[0];
+}
+
+static void setAllDirty(void){
+  dirty.settings = 1;
+  dirty.profile = 1;
+  dirty.tips = (1<<TipSize)-1;
+  dirty.lastChange = HAL_GetTick();
+}
+
 
 //This is done to avoid huge stack build up. Trigger a save using checkSettings with a flag instead direct call from menu.
 void saveSettingsFromMenu(uint8_t mode){
@@ -98,113 +477,533 @@ void saveSettingsFromMenu(uint8_t mode){
   }
 }
 
+// Blocking save. Stops the iron while writing, used on boot, errors and resets.
 void saveSettings(uint8_t mode){
 
   #ifdef NOSAVESETTINGS
     return;
   #endif
 
-  uint32_t error=0;
-  uint8_t profile = systemSettings.settings.currentProfile;
-
-  flashSettings_t flashBuffer=*flashSettings;
+  finishSaving();                                                   // Complete any background save first
+  startSaving(mode);
+  writeFlash();
+}
 
+// Stop the iron while the flash is written. ADC readings are skipped until it's resumed
+static void stopIron(void){
   while(ADC_Status != ADC_Idle);
   __disable_irq();
   systemSettings.isSaving = 1;
   configurePWMpin(output_Low);
   __enable_irq();
+}
 
-  if( (systemSettings.settings.NotInitialized!=initialized) || (systemSettings.Profile.NotInitialized!=initialized) ){
-    Error_Handler();
+static void resumeIron(void){
+  __disable_irq();
+  systemSettings.isSaving = 0;
+  __enable_irq();
+}
+
+// Write the started save, stopping the iron
+static void writeFlash(void){
+  stopIron();
+  while(flashWriter.state!=flash_Idle){
+    HAL_IWDG_Refresh(&hiwdg);
+    flashWriterStep(1);
   }
+  resumeIron();
+}
 
-  systemSettings.settingsChecksum = ChecksumSettings(&systemSettings.settings);
-  flashBuffer.settingsChecksum = systemSettings.settingsChecksum;
-  flashBuffer.settings = systemSettings.settings;
+// Complete the background save, if any. The iron keeps running.
+void finishSaving(void){
+  while(flashWriter.state!=flash_Idle){
+    HAL_IWDG_Refresh(&hiwdg);
+    flashWriterStep(0);
+  }
+}
 
-  if(mode==keepProfiles){
-    if((systemSettings.settings.currentProfile<=profile_C210) &&
-       (systemSettings.Profile.ID == profile )){
+static slotHeader_t *getSlot(uint8_t slot){
+  return (slotHeader_t*)(FLASH_ADDR+((uint32_t)slot*SLOT_SIZE));
+}
+
+static flashSettings_t *getSlotData(uint8_t slot){
+  return (flashSettings_t*)((uint8_t*)getSlot(slot)+sizeof(slotHeader_t));
+}
+
+// Slot was completely written and verified
+static bool isSlotValid(uint8_t slot){
+  slotHeader_t *header = getSlot(slot);
+
+  if( (header->commit!=slot_Committed) || (header->length<sizeof(flashSettings_t)) || (header->length>SLOT_DATA_SIZE) ){
+    return 0;
+  }
+  return (ChecksumBlock(getSlotData(slot), header->length) == header->checksum);
+}
 
-      systemSettings.ProfileChecksum = ChecksumProfile(&systemSettings.Profile);
-      flashBuffer.ProfileChecksum[profile] = systemSettings.ProfileChecksum;
-      flashBuffer.Profile[profile] = systemSettings.Profile;
+// Use the newest valid slot. An interrupted save leaves an uncommitted slot, so the previous data is used.
+static void findActiveSlot(void){
+  tipCursor.src = NULL;                                                         // The same address can hold other data now
+  activeSlot = slot_None;
+  for(uint8_t x=0; x<2; x++){
+    if(isSlotValid(x) && ((activeSlot==slot_None) || ((int32_t)(getSlot(x)->sequence-getSlot(activeSlot)->sequence) > 0))){
+      activeSlot = x;
     }
-    else{
-      Error_Handler();
+  }
+  if(activeSlot!=slot_None){
+    flashSettings = getSlotData(activeSlot);
+  }
+}
+
+// Saves done since the storage was first written. Each slot page is erased once every two saves
+uint32_t getFlashSaveCount(void){
+  if(activeSlot==slot_None){
+    return 0;
+  }
+  return getSlot(activeSlot)->sequence;
+}
+
+// Saves left before reaching the guaranteed flash endurance
+uint32_t getFlashSavesLeft(void){
+  uint32_t saves = getFlashSaveCount();
+
+  if(saves >= (2*FLASH_ENDURANCE)){
+    return 0;
+  }
+  return (2*FLASH_ENDURANCE)-saves;
+}
+
+// Stored data is valid and has the current format
+static bool isFlashValid(void){
+  return ((activeSlot!=slot_None) && (flashSettings->settings.NotInitialized==initialized) && (flashSettings->settings.version==SETTINGS_VERSION));
+}
+
+// Get the encoded profile from the flash. Returns 0 if not stored
+static bool getStoredProfile(uint8_t profile, const uint8_t **data, uint16_t *length){
+  if(!isFlashValid() || (profile>=ProfileSize) || (flashSettings->ProfileOffset[profile]==0xFFFF)){
+    return 0;
+  }
+  *data = (uint8_t*)flashSettings+flashSettings->ProfileOffset[profile];
+  *length = flashSettings->ProfileLength[profile];
+  if( (flashSettings->ProfileOffset[profile] < sizeof(flashSettings_t)) || ((flashSettings->ProfileOffset[profile]+*length) > getSlot(activeSlot)->length) ){
+    *length = 0;                                                                // Corrupted, will fail when decoding
+  }
+  return 1;
+}
+
+// Stream the data to the flash, block by block: encoded profiles, settings header, slot header.
+// Profiles are encoded one record at a time when they're being written, so only one record is kept in RAM.
+static void imageBegin(void){
+  memset(&writerHeader, 0xFF, sizeof(flashSettings_t));                         // Not stored profiles: Offset=0xFFFF
+  memset(flashWriter.source, source_None, sizeof(flashWriter.source));
+  flashWriter.length = sizeof(flashSettings_t);
+}
+
+static void imageAddProfile(uint8_t profile){
+  flashWriter.source[profile] = source_Encode;
+}
+
+static void imageCopyProfile(uint8_t profile){                                  // Copy the already encoded profile from the flash
+  flashWriter.source[profile] = source_Flash;
+}
+
+// Set the data of the current block
+static void prepareBlock(void){
+  uint8_t block = flashWriter.block;
+
+  flashWriter.written = 0;
+  flashWriter.size = 0;
+  flashWriter.tips.next = 0;
+  flashWriter.tips.tips = 0;
+  if(block<ProfileSize){
+    const uint8_t *data = recordBuffer;
+    uint16_t length = 0;
+
+    if(flashWriter.source[block]==source_Encode){
+      length = flashWriter.encode(block);
+    }
+    else if(flashWriter.source[block]==source_Flash){
+      if(getStoredProfile(block, &data, &length) && (length<=ENCODED_PROFILE_MAX)){
+        writerHeader.ProfileChecksum[block] = flashSettings->ProfileChecksum[block];
+      }
+      else{
+        length = 0;
+      }
+    }
+    if(length){
+      writerHeader.ProfileOffset[block] = flashWriter.length;
+      writerHeader.ProfileLength[block] = length;
+      flashWriter.src = data;
+      flashWriter.dest = sizeof(slotHeader_t)+flashWriter.length;
+      flashWriter.size = length;
     }
   }
+  else if(block==BLOCK_HEADER){
+    flashWriter.src = (uint8_t*)&writerHeader;
+    flashWriter.dest = sizeof(slotHeader_t);
+    flashWriter.size = sizeof(flashSettings_t);
+  }
+  else{                                                                         // All the data is written, now the checksum can be computed
+    writerSlot.length = flashWriter.length;
+    writerSlot.checksum = ChecksumBlock(getSlotData(flashWriter.slot), flashWriter.length);
+    flashWriter.src = (uint8_t*)&writerSlot + sizeof(writerSlot.commit);        // Everything but the commit mark, it's written at the end
+    flashWriter.dest = sizeof(writerSlot.commit);
+    flashWriter.size = sizeof(slotHeader_t) - sizeof(writerSlot.commit);
+  }
+}
+
+// Encode the next tip of the profile being written, after the odd byte left in the buffer (Only halfwords can be programmed)
+static void nextRecord(void){
+  uint8_t carry = flashWriter.size-flashWriter.written;
+  uint8_t length;
+  tipData tip;
+
+  if(carry){
+    recordBuffer[0] = recordBuffer[flashWriter.written];
+  }
+  flashWriter.getTip(flashWriter.tips.next, &tip);
+  length = encodeNextTip(&flashWriter.tips, &tip, &recordBuffer[carry]);
+  writerHeader.ProfileLength[flashWriter.block] += length;
+  flashWriter.dest += flashWriter.written;
+  flashWriter.written = 0;
+  flashWriter.size = carry+length;
+}
+
+// The block was written, the next one starts after it
+static void endBlock(void){
+  uint8_t block = flashWriter.block;
+
+  if((block<ProfileSize) && (writerHeader.ProfileOffset[block]!=0xFFFF)){
+    flashWriter.length += (writerHeader.ProfileLength[block]+1)&~1;            // Keep the blocks halfword aligned
+  }
+}
+
+static void imageEnd(settings_t *settings, uint16_t (*encode)(uint8_t profile)){
+  writerHeader.settings = *settings;
+  writerHeader.settingsChecksum = ChecksumSettings(&writerHeader.settings);
+  writerSlot.commit = 0xFFFF;
+  writerSlot.sequence = (activeSlot==slot_None) ? 1 : getSlot(activeSlot)->sequence+1;
+  flashWriter.encode = encode;
+  flashWriter.slot = (activeSlot==0) ? 1 : 0;                                   // Write the other slot, the active one is kept until the new one is committed
+  flashWriter.page = 0;
+  flashWriter.block = 0;
+  flashWriter.startTime = HAL_GetTick();
+  prepareBlock();
+  flashWriter.state = flash_Erase;
+}
+
+// Tips of the profile in RAM. The other tips can't change while saving, the current one is copied when the profile is encoded
+static void getSavedTip(uint8_t tip, tipData *data){
+  if(tip==tipTable.current){
+    copyTip(data, &flashWriter.currentTip);
+  }
   else{
-    for(uint8_t x=0;x<ProfileSize;x++){
-      flashBuffer.Profile[x].NotInitialized = 0xFF;
-      flashBuffer.ProfileChecksum[x] = 0xFFFFFFFF;
-      memset(&flashBuffer.Profile[x],0xFF,sizeof(profile_t));
-    }
+    getTipData(tip, data);
   }
-  __disable_irq();
-  HAL_FLASH_Unlock();
+}
 
-  FLASH_EraseInitTypeDef erase;
-  erase.NbPages = (1024*StoreSize)/FLASH_PAGE_SIZE;
-  erase.PageAddress = FLASH_ADDR;
-  erase.TypeErase = FLASH_TYPEERASE_PAGES;
+// Encode the profile in RAM
+static uint16_t encodeCurrentProfile(uint8_t profile){
+  profile_t data;
+  uint16_t length;
 
-  if((HAL_FLASHEx_Erase(&erase, &error)!=HAL_OK) || (error!=0xFFFFFFFF)){
-    Flash_error();
+  if(systemSettings.Profile.ID != profile){
+    Error_Handler();
   }
-  HAL_FLASH_Lock();
+  __disable_irq();                                                              // Take a copy, so the iron can't modify the data while encoding it
+  memcpy(&data, &systemSettings.Profile, sizeof(profile_t));
   __enable_irq();
+  if(tipTable.current!=tip_None){
+    getTipData(tipTable.current, &flashWriter.currentTip);
+  }
+  flashWriter.getTip = getSavedTip;
+  writerHeader.ProfileChecksum[profile] = ChecksumProfile(&data, getSavedTip);
+  length = encodeProfileHeader(&data, &flashWriter.tips, recordBuffer);
+  systemSettings.ProfileChecksum = writerHeader.ProfileChecksum[profile];
+  return length;
+}
 
-  // Ensure flash was erased
-  for (uint16_t i = 0; i < sizeof(flashSettings_t)/2; i++) {
-    if( *(uint16_t*)(FLASH_ADDR+(i*2)) != 0xFFFF){
-      Flash_error();
-    }
+static uint32_t migrateVersion;
+
+static void getMigratedTip(uint8_t tip, tipData *data){
+  if(tip>=systemSettings.Profile.currentNumberOfTips){
+    getBlankTip(data);
+    return;
   }
+  getDefaultTip(data);                                                          // Defaults for the fields not existing in the old version
+  migrateTip(migrateVersion, systemSettings.Profile.ID, tip, data);
+}
 
-    __disable_irq();
-  HAL_FLASH_Unlock();
-  __enable_irq();
+// Convert the profile stored by an older firmware version. Not stored if it can't be converted
+static uint16_t encodeMigratedProfile(uint8_t profile){
+  systemSettings.settings.currentProfile = profile;
+  resetCurrentProfile();                                                        // Load defaults for the fields not existing in the old version
+  if(!migrateProfile(migrateVersion, profile, &systemSettings.Profile) || (systemSettings.Profile.ID!=profile)){
+    return 0;
+  }
+  flashWriter.getTip = getMigratedTip;
+  writerHeader.ProfileChecksum[profile] = ChecksumProfile(&systemSettings.Profile, getMigratedTip);
+  return encodeProfileHeader(&systemSettings.Profile, &flashWriter.tips, recordBuffer);
+}
 
-  uint32_t dest = (uint32_t)flashSettings;
-  uint16_t *data = (uint16_t*)&flashBuffer;
+// Convert all the data stored by an older firmware version. Anything that can't be converted is reset.
+// Returns 0 if the settings couldn't be converted, the profiles are still kept.
+static bool migrateFlash(uint32_t version){
+  uint8_t currentProfile;
+  bool converted;
 
-  // Store settings
-  // written = number of 16-bit values written
-  for(uint16_t written=0; written < (sizeof(flashSettings_t)/2); written++){
-    __disable_irq();
-    if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, dest, *data ) != HAL_OK){
-      Flash_error();
-    }
-    dest += 2;                // address +2 because we write 16 bit data
-    data++;                   // +1 because it's 16Bit pointer
-    __enable_irq();
+  resetSystemSettings();
+  converted = migrateSettings(version, &systemSettings.settings);
+  currentProfile = systemSettings.settings.currentProfile;
+  migrateVersion = version;
+
+  imageBegin();
+  for(uint8_t x=0; x<ProfileSize; x++){
+    imageAddProfile(x);
   }
+  imageEnd(&systemSettings.settings, encodeMigratedProfile);
+  writeFlash();
+  systemSettings.settings.currentProfile = currentProfile;
+  return converted;
+}
 
-  __disable_irq();
-  HAL_FLASH_Lock();
-  __enable_irq();
+// Prepare the data to be stored and start the flash writer
+static void startSaving(uint8_t mode){
 
-  if(mode==keepProfiles){
-    uint32_t ProfileFlash  = ChecksumProfile(&flashSettings->Profile[profile]);
-    uint32_t ProfileRam    = ChecksumProfile(&systemSettings.Profile);
+  #ifdef NOSAVESETTINGS
+    return;
+  #endif
 
-    if((ProfileFlash != ProfileRam) ||  (flashSettings->settings.currentProfile != profile)){
-      Flash_error();
+  uint8_t profile = systemSettings.settings.currentProfile;
+
+  if( (systemSettings.settings.NotInitialized!=initialized) || (systemSettings.Profile.NotInitialized!=initialized) ){
+    Error_Handler();
+  }
+  if(mode==keepProfiles && (profile!=profile_None) && ((profile>profile_C210) || (systemSettings.Profile.ID != profile))){
+    Error_Handler();
+  }
+
+  imageBegin();
+  if(mode==keepProfiles){
+    for(uint8_t x=0; x<ProfileSize; x++){
+      if(x==profile){
+        imageAddProfile(x);
+      }
+      else{
+        imageCopyProfile(x);
+      }
     }
   }
+  imageEnd(&systemSettings.settings, encodeCurrentProfile);
+  systemSettings.settingsChecksum = writerHeader.settingsChecksum;
+}
 
-  // Check flash and system settings have same checksum
-  uint32_t SettingsFlash  = ChecksumSettings(&flashSettings->settings);
-  uint32_t SettingsRam  = ChecksumSettings(&systemSettings.settings);
-  if(SettingsFlash != SettingsRam){
-    Flash_error();
+// Check if the flash operation can be done now without disturbing the iron control.
+// The CPU stalls while the flash is busy, so we only erase/program after the ADC conversion,
+// when the heater is driven by the timer alone, and only if there's enough time until the next reading.
+// Otherwise the step is skipped and retried later. If the period can never hold it, the iron is stopped during the operation.
+static uint8_t flashWindowAvailable(uint32_t ticks){
+  if(Iron.Read_Timer==NULL){                                                                // Iron not running yet, any time is good
+    return window_Ready;
+  }
+  if(ADC_Status!=ADC_Idle){
+    return window_Wait;
   }
+  uint32_t window = systemSettings.Profile.readPeriod-(systemSettings.Profile.readDelay+1); // Current timer period (Idle = PWM active)
+  uint32_t count = __HAL_TIM_GET_COUNTER(Iron.Read_Timer);
 
-  __disable_irq();
-  systemSettings.isSaving = 0;
-  __enable_irq();
+  if(ticks >= window){                                                                      // Very short period, it will never fit
+    return window_StopIron;
+  }
+  if((count < window) && ((window-count) > ticks)){
+    return window_Ready;
+  }
+  return window_Wait;
+}
+
+// Wait for the flash window. Returns 0 if the step must be retried later
+static bool flashWindowBegin(bool blocking, uint32_t ticks, uint8_t *window){
+  *window = blocking ? window_Ready : flashWindowAvailable(ticks);
+  if(*window==window_StopIron){
+    stopIron();
+  }
+  return (*window!=window_Wait);
+}
+
+static void flashWindowEnd(uint8_t window){
+  if(window==window_StopIron){
+    resumeIron();
+  }
+}
+
+static uint32_t flashTimerCount(void){
+  if(Iron.Read_Timer==NULL){
+    return 0;
+  }
+  return __HAL_TIM_GET_COUNTER(Iron.Read_Timer);
+}
+
+static void flashStall(uint32_t start){
+  if(Iron.Read_Timer==NULL){
+    return;
+  }
+  uint32_t end = flashTimerCount();
+  uint32_t stall = end-start;
+
+  if(end<start){                                                                            // Timer reloaded, the operation overrun the window
+    stall = end + (systemSettings.Profile.readPeriod-(systemSettings.Profile.readDelay+1)) - start;
+    flashStats.overruns++;
+  }
+  if(stall > 0xFFFF){
+    stall = 0xFFFF;
+  }
+  flashStats.lastStall = stall;
+  if(stall>flashStats.maxStall){
+    flashStats.maxStall = stall;
+  }
+}
+
+// Do a small amount of work.
+// Blocking: do it now (Iron stopped). Otherwise, wait for a safe window.
+static void flashWriterStep(bool blocking){
+  uint32_t error=0, start;
+  uint8_t window;
+
+  switch(flashWriter.state){
+
+    case flash_Erase:
+    {
+      if(!flashWindowBegin(blocking, FLASH_ERASE_TICKS, &window)){
+        return;
+      }
+      FLASH_EraseInitTypeDef erase;
+      erase.NbPages = 1;
+      erase.PageAddress = (uint32_t)getSlot(flashWriter.slot) + ((uint32_t)flashWriter.page*FLASH_PAGE_SIZE);
+      erase.TypeErase = FLASH_TYPEERASE_PAGES;
+
+      start = flashTimerCount();
+      HAL_FLASH_Unlock();
+      if((HAL_FLASHEx_Erase(&erase, &error)!=HAL_OK) || (error!=0xFFFFFFFF)){
+        Flash_error();
+      }
+      HAL_FLASH_Lock();
+      flashStall(start);
+      flashWindowEnd(window);
+      flashStats.erases++;
+
+      // Ensure flash was erased
+      for (uint32_t *ptr = (uint32_t*)erase.PageAddress; ptr < (uint32_t*)(erase.PageAddress+FLASH_PAGE_SIZE); ptr++) {
+        if(*ptr != 0xFFFFFFFF){
+          Flash_error();
+        }
+      }
+      if(++flashWriter.page >= SLOT_PAGES){
+        flashWriter.state = flash_Program;
+      }
+      break;
+    }
+
+    case flash_Program:
+    {
+      uint16_t bytes = flashWriter.size - flashWriter.written;
+      bool moreTips = (flashWriter.tips.next < flashWriter.tips.tips);
+
+      if(moreTips){
+        bytes &= ~1;                                                            // An odd byte is programmed with the next record
+      }
+      if(!bytes){                                                               // Record done, prepare the next one. Doesn't stall the CPU
+        if(moreTips){
+          nextRecord();
+        }
+        else if(flashWriter.block == BLOCK_SLOT){
+          flashWriter.state = flash_Verify;
+        }
+        else{
+          endBlock();
+          flashWriter.block++;
+          prepareBlock();
+        }
+        break;
+      }
+      if(!flashWindowBegin(blocking, FLASH_PROG_TICKS, &window)){
+        return;
+      }
+      uint32_t dest = (uint32_t)getSlot(flashWriter.slot) + flashWriter.dest + flashWriter.written;
+      const uint8_t *src = flashWriter.src + flashWriter.written;
+      uint16_t count = (bytes+1)/2;
+
+      if(count>FLASH_PROG_BURST){
+        count=FLASH_PROG_BURST;
+        bytes=count*2;
+      }
+      start = flashTimerCount();
+      HAL_FLASH_Unlock();
+      for(uint16_t i=0; i<count; i++){
+        uint16_t data = src[i*2];                                               // Byte access, the source can be unaligned
+        data |= ((i*2)+1 < bytes) ? (src[(i*2)+1]<<8) : 0xFF00;                 // Odd size, pad with erased value
+        if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, dest+(i*2), data ) != HAL_OK){
+          Flash_error();
+        }
+      }
+      HAL_FLASH_Lock();
+      flashStall(start);
+      flashWindowEnd(window);
+
+      if(memcmp((uint8_t*)dest, src, bytes)!=0){                                // Check flash matches the written data
+        Flash_error();
+      }
+      flashWriter.written += bytes;
+      flashStats.bytesWritten += count*2;
+      break;
+    }
+
+    case flash_Verify:
+    {
+      flashSettings_t *data = getSlotData(flashWriter.slot);
+      if(ChecksumSettings(&data->settings) != data->settingsChecksum){
+        Flash_error();
+      }
+      flashWriter.state = flash_Commit;
+      break;
+    }
+
+    case flash_Commit:
+    {
+      if(!flashWindowBegin(blocking, FLASH_PROG_TICKS, &window)){
+        return;
+      }
+      slotHeader_t *slot = getSlot(flashWriter.slot);
+
+      start = flashTimerCount();
+      HAL_FLASH_Unlock();
+      if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, (uint32_t)&slot->commit, slot_Committed) != HAL_OK){
+        Flash_error();
+      }
+      HAL_FLASH_Lock();
+      flashStall(start);
+      flashWindowEnd(window);
+
+      if(!isSlotValid(flashWriter.slot)){
+        Flash_error();
+      }
+      activeSlot = flashWriter.slot;                                            // From now on, the new data is used
+      tipCursor.src = NULL;
+      flashSettings = getSlotData(activeSlot);
+      if( (flashWriter.encode==encodeCurrentProfile) && (systemSettings.Profile.ID<ProfileSize) && (flashWriter.source[systemSettings.Profile.ID]==source_Encode) ){
+        setTipsStored();                                                        // The tips in RAM were stored
+      }
+      flashStats.saves++;
+      flashStats.bytesWritten += sizeof(writerSlot.commit);
+      flashStats.lastSaveTime = HAL_GetTick()-flashWriter.startTime;
+      if(flashStats.lastSaveTime > flashStats.maxSaveTime){
+        flashStats.maxSaveTime = flashStats.lastSaveTime;
+      }
+      flashWriter.state = flash_Idle;
+      break;
+    }
+
+    default:
+      break;
+  }
 }
 
 void restoreSettings() {
@@ -212,16 +1011,24 @@ void restoreSettings() {
   resetSystemSettings();                                              // TODO not tested with the new profile system
   systemSettings.settings.currentProfile = profile_T12;
   resetCurrentProfile();
-  setupPID(systemSettings.Profile.tip[0].PID;);
+  setCurrentTip(systemSettings.Profile.currentTip);
   return;
 #endif
 
-  if(flashSettings->settings.NotInitialized != initialized){
+  bool migrationError = 0;
+
+  findActiveSlot();
+  uint32_t version = (activeSlot==slot_None) ? getStoredVersion() : 0;  // Older firmwares didn't use slots
+
+  if((activeSlot==slot_None) && !version){                            // Nothing stored
     resetSystemSettings();
     saveSettings(wipeProfiles);
   }
   else{
     Button_reset();
+    if(version){                                                      // Stored by an older firmware, convert it
+      migrationError = !migrateFlash(version);                        // Settings lost, handled as a checksum error
+    }
   }
 
   systemSettings.settings = flashSettings->settings;
@@ -229,23 +1036,52 @@ void restoreSettings() {
   loadProfile(systemSettings.settings.currentProfile);
 
   // Compare loaded checksum with calculated checksum
-  if( (systemSettings.settings.version != SETTINGS_VERSION) || (ChecksumSettings(&systemSettings.settings)!=systemSettings.settingsChecksum) ){
+  if( migrationError || (systemSettings.settings.version != SETTINGS_VERSION) || (ChecksumSettings(&systemSettings.settings)!=systemSettings.settingsChecksum) ){
     settingsChkErr();
   }
 
   setContrast(systemSettings.settings.contrast);
 }
 
-uint32_t ChecksumSettings(settings_t* settings){
-  uint32_t checksum;
-  checksum = HAL_CRC_Calculate(&hcrc, (uint32_t*)settings, sizeof(settings_t)/sizeof(uint32_t) );
+// CRC of any size, the last bytes are padded with zeros to complete a word
+uint32_t ChecksumBlock(void* data, uint32_t size){
+  uint32_t checksum, word;
+  uint32_t words = size/sizeof(uint32_t);
+  uint32_t tail = 0;
+
+  if( words && !((uint32_t)data & 3) ){
+    checksum = HAL_CRC_Calculate(&hcrc, (uint32_t*)data, words);
+  }
+  else{                                                                   // Unaligned data (Tips, profiles in flash). Cortex-M0 can't read unaligned words
+    __HAL_CRC_DR_RESET(&hcrc);
+    checksum = hcrc.Instance->DR;
+    for(uint32_t x=0; x<words; x++){
+      memcpy(&word, (uint8_t*)data+(x*sizeof(uint32_t)), sizeof(uint32_t));
+      checksum = HAL_CRC_Accumulate(&hcrc, &word, 1);
+    }
+  }
+  if(size%sizeof(uint32_t)){
+    memcpy(&tail, (uint8_t*)data+(words*sizeof(uint32_t)), size%sizeof(uint32_t));
+    checksum = HAL_CRC_Accumulate(&hcrc, &tail, 1);
+  }
   return checksum;
 }
 
-uint32_t ChecksumProfile(profile_t* profile){
-  uint32_t checksum;
-  checksum = HAL_CRC_Calculate(&hcrc, (uint32_t*)profile, sizeof(profile_t)/sizeof(uint32_t));
-  return checksum;
+uint32_t ChecksumSettings(settings_t* settings){
+  return ChecksumBlock(settings, sizeof(settings_t));
+}
+
+// The profile checksum is the CRC of the profile data and each tip CRC, so a single tip can be updated without reading the whole profile
+uint32_t ChecksumProfile(profile_t* profile, tipAccess_t getTip){
+  uint32_t crc[TipSize+1];
+  tipData tip;
+
+  crc[0] = ChecksumBlock(profile, sizeof(profile_t));
+  for(uint8_t x=0; x<TipSize; x++){
+    getTip(x, &tip);
+    crc[x+1] = ChecksumBlock(&tip, sizeof(tipData));
+  }
+  return HAL_CRC_Calculate(&hcrc, crc, TipSize+1);
 }
 
 void resetSystemSettings(void) {
@@ -270,56 +1106,34 @@ void resetSystemSettings(void) {
   systemSettings.settings.StandMode         = mode_sleep;
   systemSettings.settings.EncoderMode       = RE_Mode_One;
   systemSettings.settings.NotInitialized    = initialized;
+  setSettingsDirty();
   __enable_irq();
 }
 
 
 void resetCurrentProfile(void){
+  const char *tipName = _BLANK_TIP;
 #ifdef NOSAVESETTINGS
   systemSettings.settings.currentProfile=profile_T12; /// Force T12 when debugging. TODO this is not tested with the profiles update!
 #endif
   __disable_irq();
     if(systemSettings.settings.currentProfile==profile_T12){
     systemSettings.Profile.ID = profile_T12;
-    for(uint8_t x = 0; x < TipSize; x++) {
-      systemSettings.Profile.tip[x].calADC_At_250   = T12_Cal250;
-      systemSettings.Profile.tip[x].calADC_At_350   = T12_Cal350;     // These values are way lower, but better to be safe than sorry
-      systemSettings.Profile.tip[x].calADC_At_450   = T12_Cal450;     // User needs to calibrate its station
-      systemSettings.Profile.tip[x].PID.Kp          = 7500;           // val = /1.000.000
-      systemSettings.Profile.tip[x].PID.Ki          = 4000;           // val = /1.000.000
-      systemSettings.Profile.tip[x].PID.Kd          = 1000;           // val = /1.000.000
-      systemSettings.Profile.tip[x].PID.maxI        = 40;             // val = /100
-      systemSettings.Profile.tip[x].PID.minI        = 0;              // val = /100
-      systemSettings.Profile.tip[x].PID.tau         = 10;             // val = /100
-      strcpy(systemSettings.Profile.tip[x].name, _BLANK_TIP);         // Empty name
-    }
-    strcpy(systemSettings.Profile.tip[0].name, "BC3 ");               // Put some generic name
+    tipName                                         = "BC3 ";         // Put some generic name
     systemSettings.Profile.currentNumberOfTips      = 1;
     systemSettings.Profile.currentTip               = 0;
     systemSettings.Profile.impedance                = 80;             // 8.0 Ohms
     systemSettings.Profile.power                    = 80;             // 80W
     systemSettings.Profile.noIronValue              = 4000;
     systemSettings.Profile.Cal250_default           = T12_Cal250;
-    systemSettings.Profile.Cal350_default           = T12_Cal350;
-    systemSettings.Profile.Cal450_default           = T12_Cal450;
+    systemSettings.Profile.Cal350_default           = T12_Cal350;     // These values are way lower, but better to be safe than sorry
+    systemSettings.Profile.Cal450_default           = T12_Cal450;     // User needs to calibrate its station
 
   }
 
   else if(systemSettings.settings.currentProfile==profile_C245){
     systemSettings.Profile.ID = profile_C245;
-    for(uint8_t x = 0; x < TipSize; x++) {
-      systemSettings.Profile.tip[x].calADC_At_250   = C245_Cal250;
-      systemSettings.Profile.tip[x].calADC_At_350   = C245_Cal350;
-      systemSettings.Profile.tip[x].calADC_At_450   = C245_Cal450;
-      systemSettings.Profile.tip[x].PID.Kp          = 1800;
-      systemSettings.Profile.tip[x].PID.Ki          = 500;
-      systemSettings.Profile.tip[x].PID.Kd          = 200;
-      systemSettings.Profile.tip[x].PID.maxI        = 10;
-      systemSettings.Profile.tip[x].PID.minI        = 0;
-      systemSettings.Profile.tip[x].PID.tau         = 10;
-      strcpy(systemSettings.Profile.tip[x].name, _BLANK_TIP);
-    }
-    strcpy(systemSettings.Profile.tip[0].name, "C245");
+    tipName                                         = "C245";
     systemSettings.Profile.currentNumberOfTips      = 1;
     systemSettings.Profile.currentTip               = 0;
     systemSettings.Profile.impedance                = 26;
@@ -332,19 +1146,7 @@ void resetCurrentProfile(void){
 
   else if(systemSettings.settings.currentProfile==profile_C210){
     systemSettings.Profile.ID = profile_C210;
-    for(uint8_t x = 0; x < TipSize; x++) {
-      systemSettings.Profile.tip[x].calADC_At_250   = C210_Cal250;
-      systemSettings.Profile.tip[x].calADC_At_350   = C210_Cal350;
-      systemSettings.Profile.tip[x].calADC_At_450   = C210_Cal450;
-      systemSettings.Profile.tip[x].PID.Kp          = 1800;
-      systemSettings.Profile.tip[x].PID.Ki          = 500;
-      systemSettings.Profile.tip[x].PID.Kd          = 200;
-      systemSettings.Profile.tip[x].PID.maxI        = 10;
-      systemSettings.Profile.tip[x].PID.minI        = 0;
-      systemSettings.Profile.tip[x].PID.tau         = 10;
-      strcpy(systemSettings.Profile.tip[x].name, _BLANK_TIP);
-    }
-    strcpy(systemSettings.Profile.tip[0].name, "C210");
+    tipName                                       = "C210";
     systemSettings.Profile.currentNumberOfTips      = 1;
     systemSettings.Profile.currentTip             = 0;
     systemSettings.Profile.power                  = 80;
@@ -370,10 +1172,14 @@ void resetCurrentProfile(void){
   systemSettings.Profile.filterFactor             = 2;
   systemSettings.Profile.tempUnit                 = mode_Celsius;
   systemSettings.Profile.NotInitialized           = initialized;
+  resetTips(tipName);                                                       // All the tips use the profile defaults
+  setProfileDirty();
+  dirty.tips = (1<<TipSize)-1;
   __enable_irq();
 }
 
 void loadProfile(uint8_t profile){
+  finishSaving();                                                               // Flash data must be complete before reading it
   while(ADC_Status!=ADC_Idle);
   __disable_irq();
   HAL_IWDG_Refresh(&hiwdg);
@@ -384,16 +1190,28 @@ void loadProfile(uint8_t profile){
     systemSettings.settings.currentProfile=profile_None;                        // Revert to none
   }
   else if(profile<=profile_C210){
-    systemSettings.Profile = flashSettings->Profile[profile];
-    systemSettings.ProfileChecksum = flashSettings->ProfileChecksum[profile];
-    if(systemSettings.Profile.NotInitialized!=initialized){
+    const uint8_t *data;
+    uint16_t length;
+    bool valid=1;
+
+    if(getStoredProfile(profile, &data, &length)){
+      for(uint8_t x=0; x<TipSize; x++){
+        strcpy(tipTable.name[x], _BLANK_TIP);
+      }
+      valid = decodeProfile(data, length, &systemSettings.Profile, loadTip) &&   // Only the names and the current tip are loaded
+              (systemSettings.Profile.currentTip < systemSettings.Profile.currentNumberOfTips);
+      setTipsStored();
+      tipTable.current = systemSettings.Profile.currentTip;
+      systemSettings.ProfileChecksum = flashSettings->ProfileChecksum[profile];
+    }
+    else{                                                                       // Profile not stored yet
       resetCurrentProfile();
-      systemSettings.ProfileChecksum = ChecksumProfile(&systemSettings.Profile);
+      systemSettings.ProfileChecksum = ChecksumProfile(&systemSettings.Profile, getTipData);
     }
 
     // Calculate data checksum and compare with stored checksum, also ensure the stored ID is the same as the requested profile
 
-    if( (profile!=systemSettings.Profile.ID) || (systemSettings.ProfileChecksum != ChecksumProfile(&systemSettings.Profile)) ){
+    if( !valid || (profile!=systemSettings.Profile.ID) || (systemSettings.ProfileChecksum != ChecksumProfile(&systemSettings.Profile, getTipData)) ){
       ProfileChkErr();
     }
     setUserTemperature(systemSettings.Profile.UserSetTemperature);
@@ -407,6 +1225,7 @@ void loadProfile(uint8_t profile){
     setSystemTempUnit(systemSettings.settings.tempUnit);
     systemSettings.Profile.tempUnit = systemSettings.settings.tempUnit;
   }
+  setAllDirty();                                                                // Recompute all the checksums in the next check
   __enable_irq();
 }
 
@@ -441,7 +1260,7 @@ void settingsChkErr(void){
   ErrCountDown(3,117,50);
 
   if(systemSettings.settings.currentProfile<=profile_C210){
-    if(systemSettings.ProfileChecksum==ChecksumProfile(&systemSettings.Profile)){   // If current profile checksum is correct
+    if(systemSettings.ProfileChecksum==ChecksumProfile(&systemSettings.Profile, getTipData)){   // If current profile checksum is correct
       uint8_t tip = systemSettings.settings.currentProfile;                         // save current tip
       resetSystemSettings();                                                        // reset settings
       systemSettings.settings.currentProfile=tip;                                   // Restore tip type
@@ -506,7 +1325,7 @@ void ErrCountDown(uint8_t Start,uint8_t  xpos, uint8_t ypos){
     length=1;
   }
   HAL_IWDG_Refresh(&hiwdg);
-  while(oled.status!=oled_idle);
+  oledWait(oledBufferBusy());
 
   while(Start){
     timErr=HAL_GetTick();
@@ -0,0 +1,284 @@
+/*
+ * settings_codec.c
+ *
+ *  Created on: Jul 12, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#include "settings_codec.h"
+
+/*
+ * Compact profile format stored in flash.
+ *
+ * All the values are stored as varints (7 bits per byte, MSB set if more bytes follow). Signed values use zigzag encoding.
+ * Only the tips in use are stored (currentNumberOfTips), each one as:
+ *  - Name, raw (TipCharSize bytes, null terminated).
+ *  - Calibration values, as the difference from the profile default calibration.
+ *  - PID values, as the difference from the previous tip (Or zero for the first one). Copied tips take 1 byte per value.
+ *
+ * Typical profile: ~30 bytes + ~15 bytes per tip, against 274 bytes for the profile with all the tips.
+ *
+ * The profile is encoded one record at a time (The profile data, then each tip), so only one record needs to be in RAM while writing.
+ * A single tip can be decoded from the flash when needed. Tips are variable length and the PID is relative to the previous tip,
+ * so the position after the last decoded tip is kept in a cursor: reading the tips in order doesn't decode the previous ones again.
+ */
+
+#define VARINT_MAX_BYTES      5                                   // 32-bit values, the last byte only has 4 bits
+
+typedef struct{
+  const uint8_t *ptr;
+  const uint8_t *end;
+  bool          error;
+}reader_t;
+
+static uint32_t zigzag(int32_t val){
+  return ((uint32_t)val<<1) ^ (uint32_t)(val>>31);
+}
+
+static int32_t unzigzag(uint32_t val){
+  return (int32_t)(val>>1) ^ -(int32_t)(val&1);
+}
+
+static uint8_t *putVarint(uint8_t *dst, uint32_t val){
+  while(val>=0x80){
+    *dst++ = (val&0x7F) | 0x80;
+    val >>= 7;
+  }
+  *dst++ = val;
+  return dst;
+}
+
+static uint8_t *putDelta(uint8_t *dst, int32_t val, int32_t ref){
+  return putVarint(dst, zigzag(val-ref));
+}
+
+// Read a varint. Longer than 5 bytes or bits above 32 are an error
+static uint32_t getVarint(reader_t *r){
+  uint32_t val=0;
+  for(uint8_t x=0; x<VARINT_MAX_BYTES; x++){
+    if(r->ptr >= r->end){
+      break;
+    }
+    uint8_t data = *r->ptr++;
+    if((x==VARINT_MAX_BYTES-1) && (data&0xF0)){
+      break;
+    }
+    val |= (uint32_t)(data&0x7F)<<(x*7);
+    if(!(data&0x80)){
+      return val;
+    }
+  }
+  r->error = 1;
+  return 0;
+}
+
+// Read a value and check it fits in the destination type.
+// Signed values are the difference from ref. The difference is checked first, so the addition can't overflow
+static int32_t getValue(reader_t *r, int32_t min, int32_t max, bool sign, int32_t ref){
+  uint32_t raw = getVarint(r);
+  int32_t val;
+
+  if(r->error){
+    return 0;
+  }
+  if(sign){
+    int32_t delta = unzigzag(raw);
+    uint32_t span = (uint32_t)max-(uint32_t)min;                          // Ranges are 16-bit at most
+
+    if( (delta > (int32_t)span) || (delta < -(int32_t)span) ){
+      r->error = 1;
+      return 0;
+    }
+    val = (int32_t)((uint32_t)delta+(uint32_t)ref);
+  }
+  else{
+    if(raw > (uint32_t)max){
+      r->error = 1;
+      return 0;
+    }
+    val = raw;
+  }
+  if(val<min || val>max){
+    r->error = 1;
+    return 0;
+  }
+  return val;
+}
+
+#define getU8(r)            (uint8_t)getValue(r, 0, UINT8_MAX, 0, 0)
+#define getS8(r)            (int8_t)getValue(r, INT8_MIN, INT8_MAX, 1, 0)
+#define getU16(r)           (uint16_t)getValue(r, 0, UINT16_MAX, 0, 0)
+#define getU16Delta(r,ref)  (uint16_t)getValue(r, 0, UINT16_MAX, 1, ref)
+#define getS16Delta(r,ref)  (int16_t)getValue(r, INT16_MIN, INT16_MAX, 1, ref)
+
+// Encode the profile data, without the tips, into dst (ENCODED_HEADER_MAX bytes). Returns the encoded length.
+// Sets the encoder for the tips, which must follow in order (encodeNextTip)
+uint8_t encodeProfileHeader(const profile_t *profile, tipEncoder_t *enc, uint8_t *dst){
+  uint8_t *p = dst;
+  uint8_t tips = profile->currentNumberOfTips;
+
+  if(tips>TipSize){
+    tips=TipSize;
+  }
+  enc->next = 0;
+  enc->tips = tips;
+  enc->cal[0] = profile->Cal250_default;
+  enc->cal[1] = profile->Cal350_default;
+  enc->cal[2] = profile->Cal450_default;
+  memset(&enc->prev, 0, sizeof(pid_values_t));
+
+  p = putVarint(p, profile->NotInitialized);
+  p = putVarint(p, profile->ID);
+  p = putVarint(p, profile->impedance);
+  p = putVarint(p, profile->tempUnit);
+  p = putVarint(p, tips);
+  p = putVarint(p, profile->currentTip);
+  p = putVarint(p, profile->filterFactor);
+  p = putDelta (p, profile->CalNTC, 0);
+  p = putVarint(p, profile->sleepTimeout);
+  p = putVarint(p, profile->standbyTimeout);
+  p = putVarint(p, profile->standbyTemperature);
+  p = putVarint(p, profile->UserSetTemperature);
+  p = putVarint(p, profile->MaxSetTemperature);
+  p = putVarint(p, profile->MinSetTemperature);
+  p = putVarint(p, profile->pwmMul);
+  p = putVarint(p, profile->readPeriod);
+  p = putVarint(p, profile->readDelay);
+  p = putVarint(p, profile->noIronValue);
+  p = putVarint(p, profile->power);
+  p = putVarint(p, profile->Cal250_default);
+  p = putVarint(p, profile->Cal350_default);
+  p = putVarint(p, profile->Cal450_default);
+  return p-dst;
+}
+
+// Encode the next tip into dst (ENCODED_TIP_MAX bytes). Returns the encoded length
+uint8_t encodeNextTip(tipEncoder_t *enc, const tipData *tip, uint8_t *dst){
+  uint8_t *p = dst;
+
+  memcpy(p, tip->name, TipCharSize);
+  p += TipCharSize;
+  p = putDelta(p, tip->calADC_At_250, enc->cal[0]);
+  p = putDelta(p, tip->calADC_At_350, enc->cal[1]);
+  p = putDelta(p, tip->calADC_At_450, enc->cal[2]);
+  p = putDelta(p, tip->PID.Kp,   enc->prev.Kp);
+  p = putDelta(p, tip->PID.Ki,   enc->prev.Ki);
+  p = putDelta(p, tip->PID.Kd,   enc->prev.Kd);
+  p = putDelta(p, tip->PID.tau,  enc->prev.tau);
+  p = putDelta(p, tip->PID.maxI, enc->prev.maxI);
+  p = putDelta(p, tip->PID.minI, enc->prev.minI);
+  enc->prev = tip->PID;
+  enc->next++;
+  return p-dst;
+}
+
+static bool readProfile(reader_t *r, profile_t *profile){
+  memset(profile, 0, sizeof(profile_t));                                  // Clear padding, so the checksum only depends on the data
+  profile->NotInitialized       = getU8(r);
+  profile->ID                   = getU8(r);
+  profile->impedance            = getU8(r);
+  profile->tempUnit             = getU8(r);
+  profile->currentNumberOfTips  = getU8(r);
+  profile->currentTip           = getU8(r);
+  profile->filterFactor         = getU8(r);
+  profile->CalNTC               = getS8(r);
+  profile->sleepTimeout         = getU8(r);
+  profile->standbyTimeout       = getU8(r);
+  profile->standbyTemperature   = getU8(r);
+  profile->UserSetTemperature   = getU16(r);
+  profile->MaxSetTemperature    = getU16(r);
+  profile->MinSetTemperature    = getU16(r);
+  profile->pwmMul               = getU16(r);
+  profile->readPeriod           = getU16(r);
+  profile->readDelay            = getU16(r);
+  profile->noIronValue          = getU16(r);
+  profile->power                = getU16(r);
+  profile->Cal250_default       = getU16(r);
+  profile->Cal350_default       = getU16(r);
+  profile->Cal450_default       = getU16(r);
+
+  return (!r->error && profile->currentNumberOfTips<=TipSize);
+}
+
+// Read the next tip. cal holds the profile default calibration, prev the PID of the previous tip
+static bool readTip(reader_t *r, const uint16_t *cal, pid_values_t *prev, tipData *tip){
+  memset(tip, 0, sizeof(tipData));
+  if((r->end-r->ptr) < TipCharSize){
+    return 0;
+  }
+  memcpy(tip->name, r->ptr, TipCharSize);
+  r->ptr += TipCharSize;
+  tip->calADC_At_250  = getU16Delta(r, cal[0]);
+  tip->calADC_At_350  = getU16Delta(r, cal[1]);
+  tip->calADC_At_450  = getU16Delta(r, cal[2]);
+  tip->PID.Kp         = getU16Delta(r, prev->Kp);
+  tip->PID.Ki         = getU16Delta(r, prev->Ki);
+  tip->PID.Kd         = getU16Delta(r, prev->Kd);
+  tip->PID.tau        = getU16Delta(r, prev->tau);
+  tip->PID.maxI       = getS16Delta(r, prev->maxI);
+  tip->PID.minI       = getS16Delta(r, prev->minI);
+  *prev = tip->PID;
+  return !r->error;
+}
+
+// Decode the profile, passing each tip to putTip (Optional). Returns 0 if the data is not valid
+bool decodeProfile(const uint8_t *src, uint16_t length, profile_t *profile, tipAccess_t putTip){
+  pid_values_t prev;
+  tipData tip;
+  reader_t r = { .ptr = src, .end = src+length, .error = 0 };
+
+  memset(&prev, 0, sizeof(pid_values_t));
+  if(!readProfile(&r, profile)){
+    return 0;
+  }
+  uint16_t cal[3] = { profile->Cal250_default, profile->Cal350_default, profile->Cal450_default };
+
+  for(uint8_t x=0; x<profile->currentNumberOfTips; x++){
+    if(!readTip(&r, cal, &prev, &tip)){
+      return 0;
+    }
+    if(putTip){
+      putTip(x, &tip);
+    }
+  }
+  return (r.ptr==r.end);
+}
+
+// Decode a single tip. Returns 0 if the data is not valid or the tip is not stored.
+// Continues from the cursor if it's the same data and the tip wasn't passed yet, otherwise starts from the beginning
+bool decodeTip(tipCursor_t *cursor, const uint8_t *src, uint16_t length, uint8_t tip, tipData *dst){
+  reader_t r = { .ptr = src, .end = src+length, .error = 0 };
+
+  if( (cursor->src!=src) || (cursor->length!=length) || (tip<cursor->next) ){
+    profile_t profile;
+
+    cursor->src = NULL;
+    if(!readProfile(&r, &profile)){
+      return 0;
+    }
+    cursor->src = src;
+    cursor->length = length;
+    cursor->next = 0;
+    cursor->tips = profile.currentNumberOfTips;
+    cursor->cal[0] = profile.Cal250_default;
+    cursor->cal[1] = profile.Cal350_default;
+    cursor->cal[2] = profile.Cal450_default;
+    memset(&cursor->prev, 0, sizeof(pid_values_t));
+    cursor->offset = r.ptr-src;
+  }
+  else{
+    r.ptr = src+cursor->offset;
+  }
+  if(tip>=cursor->tips){
+    return 0;
+  }
+  while(cursor->next<=tip){
+    if(!readTip(&r, cursor->cal, &cursor->prev, dst)){
+      cursor->src = NULL;
+      return 0;
+    }
+    cursor->next++;
+  }
+  cursor->offset = r.ptr-src;
+  return 1;
+}
@@ -0,0 +1,341 @@
+/*
+ * settings_migration.c
+ *
+ *  Created on: Jul 10, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#include "settings_migration.h"
+#include <stddef.h>
+
+/*
+ * Converts the settings stored by older firmware versions instead of resetting them.
+ *
+ * Each stored version has a schema describing the flash layout and where each field was.
+ * Fields are matched by id, so they can be moved, resized or removed between versions.
+ * Fields not found in the old version keep the default value.
+ *
+ * When changing settings_t, profile_t or tipData:
+ *  - Add the new field ids at the end of the lists below, never reuse an id.
+ *  - Add the new field to the current tables.
+ *  - If the layout changed, copy the last frozen tables with the literal offsets of the old layout and add a schema for the old version.
+ *  - If a field changed its meaning (units, scale...), add a convert function to the old table entry.
+ *  - Bump SETTINGS_VERSION.
+ */
+
+#define FIELD(id, type, member, flags)  { id, offsetof(type, member), sizeof(((type*)0)->member), flags, NULL }
+#define COUNT(x)                        (sizeof(x)/sizeof(x[0]))
+#define LEGACY_ADDR                     (0x8000000 + ((FLASH_SZ-2)*1024))   // Old versions used the last 2KB without slots (Now the second slot)
+
+enum{
+  set_NotInitialized,
+  set_contrast,
+  set_OledOffset,
+  set_currentProfile,
+  set_saveSettingsDelay,
+  set_initMode,
+  set_tempStep,
+  set_screenDimming,
+  set_tempUnit,
+  set_activeDetection,
+  set_buzzerMode,
+  set_wakeOnButton,
+  set_wakeOnShake,
+  set_WakeInputMode,
+  set_StandMode,
+  set_EncoderMode,
+  set_errorDelay,
+  set_guiUpdateDelay,
+  set_lvp,
+};
+
+enum{
+  prof_NotInitialized,
+  prof_ID,
+  prof_impedance,
+  prof_tempUnit,
+  prof_currentNumberOfTips,
+  prof_currentTip,
+  prof_filterFactor,
+  prof_CalNTC,
+  prof_sleepTimeout,
+  prof_standbyTimeout,
+  prof_standbyTemperature,
+  prof_UserSetTemperature,
+  prof_MaxSetTemperature,
+  prof_MinSetTemperature,
+  prof_pwmMul,
+  prof_readPeriod,
+  prof_readDelay,
+  prof_noIronValue,
+  prof_power,
+  prof_Cal250_default,
+  prof_Cal350_default,
+  prof_Cal450_default,
+};
+
+enum{
+  tip_calADC_At_250,
+  tip_calADC_At_350,
+  tip_calADC_At_450,
+  tip_name,
+  tip_Kp,
+  tip_Ki,
+  tip_Kd,
+  tip_tau,
+  tip_maxI,
+  tip_minI,
+};
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Current layout
+//-------------------------------------------------------------------------------------------------------------------------------
+static const schemaField_t settingsFields[] = {
+  FIELD(set_NotInitialized,       settings_t, NotInitialized,       field_Unsigned),
+  FIELD(set_contrast,             settings_t, contrast,             field_Unsigned),
+  FIELD(set_OledOffset,           settings_t, OledOffset,           field_Unsigned),
+  FIELD(set_currentProfile,       settings_t, currentProfile,       field_Unsigned),
+  FIELD(set_saveSettingsDelay,    settings_t, saveSettingsDelay,    field_Unsigned),
+  FIELD(set_initMode,             settings_t, initMode,             field_Unsigned),
+  FIELD(set_tempStep,             settings_t, tempStep,             field_Unsigned),
+  FIELD(set_screenDimming,        settings_t, screenDimming,        field_Unsigned),
+  FIELD(set_tempUnit,             settings_t, tempUnit,             field_Unsigned),
+  FIELD(set_activeDetection,      settings_t, activeDetection,      field_Unsigned),
+  FIELD(set_buzzerMode,           settings_t, buzzerMode,           field_Unsigned),
+  FIELD(set_wakeOnButton,         settings_t, wakeOnButton,         field_Unsigned),
+  FIELD(set_wakeOnShake,          settings_t, wakeOnShake,          field_Unsigned),
+  FIELD(set_WakeInputMode,        settings_t, WakeInputMode,        field_Unsigned),
+  FIELD(set_StandMode,            settings_t, StandMode,            field_Unsigned),
+  FIELD(set_EncoderMode,          settings_t, EncoderMode,          field_Unsigned),
+  FIELD(set_errorDelay,           settings_t, errorDelay,           field_Unsigned),
+  FIELD(set_guiUpdateDelay,       settings_t, guiUpdateDelay,       field_Unsigned),
+  FIELD(set_lvp,                  settings_t, lvp,                  field_Unsigned),
+};
+
+static const schemaField_t profileFields[] = {
+  FIELD(prof_NotInitialized,      profile_t,  NotInitialized,       field_Unsigned),
+  FIELD(prof_ID,                  profile_t,  ID,                   field_Unsigned),
+  FIELD(prof_impedance,           profile_t,  impedance,            field_Unsigned),
+  FIELD(prof_tempUnit,            profile_t,  tempUnit,             field_Unsigned),
+  FIELD(prof_currentNumberOfTips, profile_t,  currentNumberOfTips,  field_Unsigned),
+  FIELD(prof_currentTip,          profile_t,  currentTip,           field_Unsigned),
+  FIELD(prof_filterFactor,        profile_t,  filterFactor,         field_Unsigned),
+  FIELD(prof_CalNTC,              profile_t,  CalNTC,               field_Signed),
+  FIELD(prof_sleepTimeout,        profile_t,  sleepTimeout,         field_Unsigned),
+  FIELD(prof_standbyTimeout,      profile_t,  standbyTimeout,       field_Unsigned),
+  FIELD(prof_standbyTemperature,  profile_t,  standbyTemperature,   field_Unsigned),
+  FIELD(prof_UserSetTemperature,  profile_t,  UserSetTemperature,   field_Unsigned),
+  FIELD(prof_MaxSetTemperature,   profile_t,  MaxSetTemperature,    field_Unsigned),
+  FIELD(prof_MinSetTemperature,   profile_t,  MinSetTemperature,    field_Unsigned),
+  FIELD(prof_pwmMul,              profile_t,  pwmMul,               field_Unsigned),
+  FIELD(prof_readPeriod,          profile_t,  readPeriod,           field_Unsigned),
+  FIELD(prof_readDelay,           profile_t,  readDelay,            field_Unsigned),
+  FIELD(prof_noIronValue,         profile_t,  noIronValue,          field_Unsigned),
+  FIELD(prof_power,               profile_t,  power,                field_Unsigned),
+  FIELD(prof_Cal250_default,      profile_t,  Cal250_default,       field_Unsigned),
+  FIELD(prof_Cal350_default,      profile_t,  Cal350_default,       field_Unsigned),
+  FIELD(prof_Cal450_default,      profile_t,  Cal450_default,       field_Unsigned),
+};
+
+static const schemaField_t tipFields[] = {
+  FIELD(tip_calADC_At_250,        tipData,    calADC_At_250,        field_Unsigned),
+  FIELD(tip_calADC_At_350,        tipData,    calADC_At_350,        field_Unsigned),
+  FIELD(tip_calADC_At_450,        tipData,    calADC_At_450,        field_Unsigned),
+  FIELD(tip_name,                 tipData,    name,                 field_Unsigned),
+  FIELD(tip_Kp,                   tipData,    PID.Kp,               field_Unsigned),
+  FIELD(tip_Ki,                   tipData,    PID.Ki,               field_Unsigned),
+  FIELD(tip_Kd,                   tipData,    PID.Kd,               field_Unsigned),
+  FIELD(tip_tau,                  tipData,    PID.tau,              field_Unsigned),
+  FIELD(tip_maxI,                 tipData,    PID.maxI,             field_Signed),
+  FIELD(tip_minI,                 tipData,    PID.minI,             field_Signed),
+};
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Frozen layouts. Never modify these!
+//-------------------------------------------------------------------------------------------------------------------------------
+// v5
+static const schemaField_t settingsFields_v5[] = {
+  { set_NotInitialized,        0, 1 },
+  { set_contrast,              1, 1 },
+  { set_OledOffset,            2, 1 },
+  { set_currentProfile,        3, 1 },
+  { set_saveSettingsDelay,     4, 1 },
+  { set_initMode,              5, 1 },
+  { set_tempStep,              6, 1 },
+  { set_screenDimming,         7, 1 },
+  { set_tempUnit,              8, 1 },
+  { set_activeDetection,       9, 1 },
+  { set_buzzerMode,           10, 1 },
+  { set_wakeOnButton,         11, 1 },
+  { set_wakeOnShake,          12, 1 },
+  { set_WakeInputMode,        13, 1 },
+  { set_StandMode,            14, 1 },
+  { set_EncoderMode,          15, 1 },
+  { set_errorDelay,           16, 2 },
+  { set_guiUpdateDelay,       18, 2 },
+  { set_lvp,                  20, 2 },
+};
+
+static const schemaField_t profileFields_v5[] = {
+  { prof_NotInitialized,       0, 1 },
+  { prof_ID,                   1, 1 },
+  { prof_impedance,            2, 1 },
+  { prof_tempUnit,             3, 1 },
+  { prof_currentNumberOfTips,  4, 1 },
+  { prof_currentTip,           5, 1 },
+  { prof_filterFactor,         6, 1 },
+  { prof_CalNTC,               7, 1, field_Signed },
+  { prof_sleepTimeout,         8, 1 },
+  { prof_standbyTimeout,       9, 1 },
+  { prof_standbyTemperature,  10, 1 },
+  { prof_UserSetTemperature,  12, 2 },
+  { prof_MaxSetTemperature,   14, 2 },
+  { prof_MinSetTemperature,   16, 2 },
+  { prof_pwmMul,              18, 2 },
+  { prof_readPeriod,          20, 2 },
+  { prof_readDelay,           22, 2 },
+  { prof_noIronValue,         24, 2 },
+  { prof_power,               26, 2 },
+  { prof_Cal250_default,      28, 2 },
+  { prof_Cal350_default,      30, 2 },
+  { prof_Cal450_default,      32, 2 },
+};
+
+static const schemaField_t tipFields_v5[] = {
+  { tip_calADC_At_250,         0, 2 },
+  { tip_calADC_At_350,         2, 2 },
+  { tip_calADC_At_450,         4, 2 },
+  { tip_name,                  6, 5 },
+  { tip_Kp,                   12, 2 },
+  { tip_Ki,                   14, 2 },
+  { tip_Kd,                   16, 2 },
+  { tip_tau,                  18, 2 },
+  { tip_maxI,                 20, 2, field_Signed },
+  { tip_minI,                 22, 2, field_Signed },
+};
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Known versions, newest first
+//-------------------------------------------------------------------------------------------------------------------------------
+static const schema_t schemas[] = {
+  {
+    .version = 5,                 .checksum = checksum_Words,         .tips = 10,
+    .profileSize = 274,           .tipOffset = 34,                    .tipSize = 24,
+    .profileChecksumOffset = 824, .settingsOffset = 836,              .settingsSize = 28,
+    .settingsChecksumOffset = 864,.versionOffset = 24,
+    .settingsFields = settingsFields_v5,  .settingsFieldCount = COUNT(settingsFields_v5),
+    .profileFields = profileFields_v5,    .profileFieldCount = COUNT(profileFields_v5),
+    .tipFields = tipFields_v5,            .tipFieldCount = COUNT(tipFields_v5),
+  },
+};
+
+static const schema_t *findSchema(uint32_t version){
+  for(uint8_t x=0; x<COUNT(schemas); x++){
+    if(schemas[x].version==version){
+      return &schemas[x];
+    }
+  }
+  return NULL;
+}
+
+static uint32_t readWord(uint32_t offset){
+  uint32_t data;
+  memcpy(&data, (uint8_t*)LEGACY_ADDR+offset, sizeof(uint32_t));
+  return data;
+}
+
+// Copy the fields found in the old record into the new one
+static void copyFields(const schemaField_t *old, uint8_t oldCount, const uint8_t *src,
+                       const schemaField_t *new, uint8_t newCount, uint8_t *dst){
+
+  for(uint8_t n=0; n<newCount; n++){
+    for(uint8_t o=0; o<oldCount; o++){
+      if(old[o].id != new[n].id){
+        continue;
+      }
+      if(old[o].convert){
+        old[o].convert(src+old[o].offset, dst+new[n].offset);
+      }
+      else{
+        uint8_t size = (old[o].size < new[n].size) ? old[o].size : new[n].size;
+        uint8_t fill = 0;
+
+        if((old[o].flags & field_Signed) && (src[old[o].offset+old[o].size-1] & 0x80)){    // Extend the sign if the field got bigger
+          fill = 0xFF;
+        }
+        memset(dst+new[n].offset, fill, new[n].size);
+        memcpy(dst+new[n].offset, src+old[o].offset, size);                               // Little endian, lowest bytes first
+      }
+      break;
+    }
+  }
+}
+
+static uint32_t schemaChecksumProfile(const schema_t *s, const uint8_t *profile){
+  if(s->checksum==checksum_Words){
+    return ChecksumBlock((void*)profile, (s->profileSize/sizeof(uint32_t))*sizeof(uint32_t));
+  }
+  return 0;
+}
+
+static uint32_t schemaChecksumSettings(const schema_t *s, const uint8_t *settings){
+  if(s->checksum==checksum_Words){
+    return ChecksumBlock((void*)settings, (s->settingsSize/sizeof(uint32_t))*sizeof(uint32_t));
+  }
+  return 0;
+}
+
+// Returns the version of the data stored in flash, 0 if unknown
+uint32_t getStoredVersion(void){
+  for(uint8_t x=0; x<COUNT(schemas); x++){
+    const schema_t *s = &schemas[x];
+    if( (*((uint8_t*)LEGACY_ADDR+s->settingsOffset) == initialized) && (readWord(s->settingsOffset+s->versionOffset) == s->version) ){
+      return s->version;
+    }
+  }
+  return 0;
+}
+
+// Load the stored settings into dst. Fields that didn't exist in that version are not modified, so dst must be filled with defaults first.
+bool migrateSettings(uint32_t version, settings_t *dst){
+  const schema_t *s = findSchema(version);
+  if(s==NULL){
+    return 0;
+  }
+  const uint8_t *src = (uint8_t*)LEGACY_ADDR+s->settingsOffset;
+
+  if(schemaChecksumSettings(s, src) != readWord(s->settingsChecksumOffset)){
+    return 0;
+  }
+  copyFields(s->settingsFields, s->settingsFieldCount, src, settingsFields, COUNT(settingsFields), (uint8_t*)dst);
+  dst->version = SETTINGS_VERSION;
+  return 1;
+}
+
+// Load the stored profile into dst, without the tips. Same as above, dst must contain the default profile values.
+bool migrateProfile(uint32_t version, uint8_t profile, profile_t *dst){
+  const schema_t *s = findSchema(version);
+  if(s==NULL || profile>=ProfileSize){
+    return 0;
+  }
+  const uint8_t *src = (uint8_t*)LEGACY_ADDR+(profile*s->profileSize);
+
+  if( (*src != initialized) || (schemaChecksumProfile(s, src) != readWord(s->profileChecksumOffset+(profile*sizeof(uint32_t)))) ){
+    return 0;
+  }
+  copyFields(s->profileFields, s->profileFieldCount, src, profileFields, COUNT(profileFields), (uint8_t*)dst);
+  return 1;
+}
+
+// Load a tip of the stored profile into dst, dst must contain the default tip values.
+// The profile must have been checked by migrateProfile() first.
+bool migrateTip(uint32_t version, uint8_t profile, uint8_t tip, tipData *dst){
+  const schema_t *s = findSchema(version);
+  if(s==NULL || profile>=ProfileSize || tip>=s->tips){
+    return 0;
+  }
+  const uint8_t *src = (uint8_t*)LEGACY_ADDR+(profile*s->profileSize)+s->tipOffset+(tip*s->tipSize);
+
+  copyFields(s->tipFields, s->tipFieldCount, src, tipFields, COUNT(tipFields), (uint8_t*)dst);
+  return 1;
+}
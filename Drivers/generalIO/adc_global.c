@@ -111,6 +111,7 @@ void ADC_Start_DMA(){
     Error_Handler();
   }
   if(systemSettings.isSaving){                                                              // If saving, skip ADC conversion (PWM pin disabled)
+    flashStats.skippedReads++;
     ADC_Status=ADC_Idle;
     HAL_IWDG_Refresh(&hiwdg);
     return;
@@ -166,7 +167,7 @@ void DoAverage(volatile ADCDataTypeDef_t* InputData){
   if(systemSettings.Profile.filterFactor > 0) {                                             // Advanced filtering enabled?
 
     if(systemSettings.Profile.filterFactor>8){                                              // Limit coefficient, more than 8 will cause overflow
-      systemSettings.Profile.filterFactor=8;
+      setProfileValue(filterFactor, 8);
     }
     shift = systemSettings.Profile.filterFactor;                                            // Set EMA factor setting from system settings
 
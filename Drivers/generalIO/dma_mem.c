@@ -0,0 +1,69 @@
+/*
+ * dma_mem.c
+ *
+ *  Created on: Jul 20, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#include "dma_mem.h"
+
+/*
+ * Memory fill/copy using the mem2mem DMA channel (FILL_DMA), 32-bit transfers.
+ *
+ * The transfers run in background, the functions return as soon as the DMA is started.
+ * Before using the destination (Or the source of a copy), call dma_mem_wait().
+ * Starting a new transfer waits for the previous one, so there's only one transfer at a time.
+ *
+ * The channel has no interrupt, the end of the transfer is checked by polling.
+ * Small or unaligned transfers are done by the CPU.
+ */
+
+static DMA_HandleTypeDef *memDMA;
+static uint32_t fillValue;                                          // The DMA reads the value during the transfer, can't be in the stack
+
+void dma_mem_init(DMA_HandleTypeDef *dma){
+  memDMA = dma;
+}
+
+// Wait for the current transfer, if any
+void dma_mem_wait(void){
+  if(memDMA && memDMA->State==HAL_DMA_STATE_BUSY){
+    HAL_DMA_PollForTransfer(memDMA, HAL_DMA_FULL_TRANSFER, 3000);     // Also clears the flags and sets the handle ready
+  }
+}
+
+static bool dma_mem_start(uint32_t src, void *dst, uint16_t bytes, bool srcInc){
+  dma_mem_wait();
+  if(!memDMA || bytes<DMA_MEM_MIN || (bytes&3) || ((uint32_t)dst&3) || (srcInc && (src&3))){
+    return 0;
+  }
+  __HAL_DMA_DISABLE(memDMA);                                        // Source increment can only be changed with the channel disabled
+  if(srcInc){
+    memDMA->Instance->CCR |= DMA_CCR_PINC;
+    memDMA->Init.PeriphInc = DMA_PINC_ENABLE;
+  }
+  else{
+    memDMA->Instance->CCR &= ~DMA_CCR_PINC;
+    memDMA->Init.PeriphInc = DMA_PINC_DISABLE;
+  }
+  return (HAL_DMA_Start(memDMA, src, (uint32_t)dst, bytes/sizeof(uint32_t))==HAL_OK);
+}
+
+// Fill bytes (Multiple of 4, dst 32-bit aligned) with a 32-bit value
+void dma_memset32(void *dst, uint32_t value, uint16_t bytes){
+  dma_mem_wait();                                                   // The previous fill might be still reading fillValue
+  fillValue = value;
+  if(!dma_mem_start((uint32_t)&fillValue, dst, bytes, 0)){
+    uint32_t *p = dst;
+    for(uint16_t x=0; x<bytes/sizeof(uint32_t); x++){
+      p[x] = value;
+    }
+  }
+}
+
+// Copy bytes, the areas can't overlap
+void dma_memcpy32(void *dst, const void *src, uint16_t bytes){
+  if(!dma_mem_start((uint32_t)src, dst, bytes, 1)){
+    memcpy(dst, src, bytes);
+  }
+}
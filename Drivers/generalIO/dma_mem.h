@@ -0,0 +1,20 @@
+/*
+ * dma_mem.h
+ *
+ *  Created on: Jul 20, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#ifndef GENERALIO_DMA_MEM_H_
+#define GENERALIO_DMA_MEM_H_
+
+#include "main.h"
+
+#define DMA_MEM_MIN   64                                            // Smaller transfers are done by the CPU, faster than setting up the DMA
+
+void dma_mem_init(DMA_HandleTypeDef *dma);
+void dma_memset32(void *dst, uint32_t value, uint16_t bytes);
+void dma_memcpy32(void *dst, const void *src, uint16_t bytes);
+void dma_mem_wait(void);
+
+#endif /* GENERALIO_DMA_MEM_H_ */
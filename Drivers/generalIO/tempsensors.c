@@ -74,7 +74,7 @@ int16_t readTipTemperatureCompensated(bool update, bool ReadRaw){
 }
 
 void setCurrentTip(uint8_t tip) {
-  currentTipData = &systemSettings.Profile.tip[tip];
+  currentTipData = selectTip(tip);
   setupPID(&currentTipData->PID);
 }
 
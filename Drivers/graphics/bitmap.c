@@ -0,0 +1,122 @@
+/*
+ * bitmap.c
+ *
+ *  Created on: Jul 24, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#include "bitmap.h"
+#include "dma_mem.h"
+
+/*
+ * Draws the page format bitmaps straight into the buffer.
+ * Aligned to a page, each byte is written to one buffer byte. Otherwise it's shifted and split in two pages.
+ * Clipped like u8g2 does, to the drawing window (user_x0...user_y1: the buffer and the clip window).
+ */
+
+// Rows of the buffer page inside the drawing window, as a bit mask
+static uint8_t windowRows(u8g2_t *u8g2, int8_t page){
+  int16_t top = page*8;
+  uint8_t rows = 0;
+
+  for(uint8_t r=0; r<8; r++){
+    if(top+r>=u8g2->user_y0 && top+r<u8g2->user_y1){
+      rows |= 1<<r;
+    }
+  }
+  return rows;
+}
+
+// Draw one page of the bitmap. Page is the buffer page for the top of the row, can be outside the buffer.
+// Mask are the rows of the bitmap in this page, drawn in the background color where the bitmap is clear. 0 draws only the set pixels.
+static void drawRow(u8g2_t *u8g2, int16_t x, int8_t page, uint8_t shift, const uint8_t *src, uint8_t width, uint8_t mask){
+  uint8_t *buffer = u8g2_GetBufferPtr(u8g2);
+  int16_t bufWidth = u8g2->pixel_buf_width;
+  int8_t bufPages = u8g2->tile_buf_height;
+  uint8_t color = u8g2->draw_color;
+  int16_t start = (x<(int16_t)u8g2->user_x0) ? u8g2->user_x0-x : 0;       // Visible columns
+  int16_t end = (x+width>(int16_t)u8g2->user_x1) ? u8g2->user_x1-x : width;
+  uint16_t rows = windowRows(u8g2, page) | ((uint16_t)windowRows(u8g2, page+1)<<8);   // Visible rows, same layout as the shifted data
+  uint8_t *lo = (page>=0 && page<bufPages && (rows&0xFF)) ? &buffer[(page*bufWidth)+x] : NULL;
+  uint8_t *hi = (shift && page+1>=0 && page+1<bufPages && (rows>>8)) ? &buffer[((page+1)*bufWidth)+x] : NULL;
+
+#ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if(!u8g2->is_page_clip_window_intersection){
+    return;
+  }
+#endif
+  if(!mask && color==1){                                        // Most common case, just OR the data
+    for(int16_t c=start; c<end; c++){
+      uint16_t data = ((uint16_t)src[c] << shift) & rows;
+      if(lo){ lo[c] |= data; }
+      if(hi){ hi[c] |= data>>8; }
+    }
+    return;
+  }
+  for(int16_t c=start; c<end; c++){
+    uint16_t data = ((uint16_t)src[c] << shift) & rows;         // Low byte for this page, high byte for the next one
+    uint16_t m = (mask ? ((uint16_t)mask << shift) : data) & rows;   // Pixels to change
+    if(!m){
+      continue;
+    }
+    if(lo){
+      lo[c] = (lo[c] & ~m) | ((color==1) ? data : (color==0) ? (m & ~data) : (~lo[c] & data));
+    }
+    if(hi){
+      uint8_t d = data>>8, h = m>>8;
+      hi[c] = (hi[c] & ~h) | ((color==1) ? d : (color==0) ? (h & ~d) : (~hi[c] & d));
+    }
+  }
+}
+
+// Draw uncompressed page data, only the set pixels (Like the fonts)
+void drawPages(u8g2_t *u8g2, int16_t x, int16_t y, uint8_t width, uint8_t pages, const uint8_t *data){
+  int8_t page = (y>=0) ? (y/8) : -((7-y)/8);                    // Round down
+  uint8_t shift = y&7;
+
+  dma_mem_wait();                                               // Writing to the buffer directly, wait for the DMA fill
+  for(uint8_t p=0; p<pages; p++){
+    drawRow(u8g2, x, page+p, shift, &data[p*width], width, 0);
+  }
+}
+
+// Draw a bitmap made by xbm2page. Like u8g2_DrawXBMP, the clear pixels are drawn in the background color unless the bitmap mode is transparent
+void drawBitmap(u8g2_t *u8g2, int16_t x, int16_t y, const uint8_t *bmp){
+  uint8_t width = bmp[0];
+  uint8_t height = bmp[1];
+  uint8_t pages = (height+7)/8;
+  bool solid = !u8g2->bitmap_transparency;
+  const uint8_t *src = &bmp[3];
+  int8_t page = (y>=0) ? (y/8) : -((7-y)/8);                    // Round down
+  uint8_t shift = y&7;
+  uint8_t row[BITMAP_MAX_WIDTH];
+  uint8_t count=0, repeat=0, value=0;
+
+  if(width>BITMAP_MAX_WIDTH){
+    return;
+  }
+  dma_mem_wait();
+  for(uint8_t p=0; p<pages; p++){
+    uint8_t mask = 0;
+    if(solid){
+      mask = (p==pages-1 && (height&7)) ? ((1<<(height&7))-1) : 0xFF;
+    }
+    if(!(bmp[2] & BITMAP_RLE)){
+      drawRow(u8g2, x, page+p, shift, &src[p*width], width, mask);
+      continue;
+    }
+    for(uint8_t c=0; c<width; c++){                             // Decompress a page. Runs can continue in the next page
+      if(!count){
+        uint8_t ctrl = *src++;
+        repeat = (ctrl>=128);
+        count = repeat ? (ctrl-126) : (ctrl+1);
+        if(repeat){
+          value = *src++;
+        }
+      }
+      row[c] = repeat ? value : *src++;
+      count--;
+    }
+    drawRow(u8g2, x, page+p, shift, row, width, mask);
+  }
+}
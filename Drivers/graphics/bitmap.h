@@ -0,0 +1,26 @@
+/*
+ * bitmap.h
+ *
+ *  Created on: Jul 24, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#ifndef GRAPHICS_BITMAP_H_
+#define GRAPHICS_BITMAP_H_
+
+#include "u8g2.h"
+#include "main.h"
+
+/*
+ * Bitmaps in the display format, made by u8g2/tools/xbm2page from XBM files:
+ *  Width, height, flags, data.
+ *  The data is stored page by page (8 rows), a byte per column, LSB on top.
+ *  With BITMAP_RLE, the data is compressed: A control byte n<128 is followed by n+1 bytes, n>=128 repeats the next byte n-126 times.
+ */
+#define BITMAP_RLE        0x01
+#define BITMAP_MAX_WIDTH  128
+
+void drawBitmap(u8g2_t *u8g2, int16_t x, int16_t y, const uint8_t *bmp);
+void drawPages(u8g2_t *u8g2, int16_t x, int16_t y, uint8_t width, uint8_t pages, const uint8_t *data);
+
+#endif /* GRAPHICS_BITMAP_H_ */
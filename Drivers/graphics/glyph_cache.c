@@ -0,0 +1,215 @@
+/*
+ * glyph_cache.c
+ *
+ *  Created on: Jul 22, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#include "glyph_cache.h"
+#include "bitmap.h"
+
+/*
+ * Cache for the large font glyphs, stored already decoded in the display format (Vertical bytes, pages of 8 rows).
+ *
+ * Decoding a u8g2 glyph reads the run-length data bit by bit, and draws each run as a line.
+ * For the big temperature digits that's slow, and they are redrawn all the time.
+ * The cached glyphs are drawn with drawPages(), a byte per column and page.
+ *
+ * The glyphs are decoded by u8g2 itself, drawing them with the hvline function replaced by one writing to the cache.
+ * Only the fonts in cachedFonts are cached, with transparent font mode, no rotation and no clip window. Otherwise u8g2 draws them.
+ * The glyph data is stored in a pool of GLYPH_CACHE_BYTES, the least used glyphs are removed when it's full.
+ * "350°C" takes ~570 bytes, 800 bytes also fit the digits around it.
+ */
+
+#ifdef GLYPH_CACHE_BYTES
+
+typedef struct{
+  const uint8_t   *font;                                        // NULL if empty
+  uint16_t        encoding;
+  uint16_t        offset;                                       // Data position in the pool
+  uint16_t        lastUse;
+  int8_t          x;                                            // Glyph position from the draw position and the font baseline
+  int8_t          y;
+  int8_t          dx;                                           // Advance to the next glyph
+  uint8_t         width;
+  uint8_t         pages;
+  bool            valid;                                        // Glyph data is cached, otherwise it's drawn by u8g2
+}glyph_t;
+
+static const uint8_t * const cachedFonts[] = { u8g2_font_ironTemp };
+
+static glyph_t cache[GLYPH_CACHE_ENTRIES];
+static uint8_t pool[GLYPH_CACHE_BYTES];                          // Glyph data, page by page, width bytes each
+static uint16_t poolUsed;
+static uint16_t useCount;
+static glyph_t *capture;
+
+static bool isCachedFont(const uint8_t *font){
+  for(uint8_t x=0; x<sizeof(cachedFonts)/sizeof(cachedFonts[0]); x++){
+    if(font==cachedFonts[x]){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static uint16_t glyphSize(glyph_t *g){
+  return g->valid ? (uint16_t)g->width*g->pages : 0;
+}
+
+static glyph_t *leastUsed(glyph_t *skip){
+  glyph_t *g = NULL;
+  for(uint8_t x=0; x<GLYPH_CACHE_ENTRIES; x++){
+    if(!cache[x].font){
+      return &cache[x];
+    }
+    if(&cache[x]!=skip && (!g || (uint16_t)(useCount-cache[x].lastUse) > (uint16_t)(useCount-g->lastUse))){
+      g = &cache[x];
+    }
+  }
+  return g;
+}
+
+// Remove the glyph data, moving down the data after it
+static void freeData(glyph_t *g){
+  uint16_t size = glyphSize(g);
+  if(size){
+    memmove(&pool[g->offset], &pool[g->offset+size], poolUsed-(g->offset+size));
+    for(uint8_t x=0; x<GLYPH_CACHE_ENTRIES; x++){
+      if(glyphSize(&cache[x]) && cache[x].offset>g->offset){
+        cache[x].offset -= size;
+      }
+    }
+    poolUsed -= size;
+  }
+  g->valid = 0;
+}
+
+static void removeGlyph(glyph_t *g){
+  freeData(g);
+  g->font = NULL;
+}
+
+// Get space for the glyph data, removing the least used glyphs if needed
+static bool allocData(glyph_t *g, uint16_t size){
+  if(size>GLYPH_CACHE_BYTES){
+    return 0;
+  }
+  while((GLYPH_CACHE_BYTES-poolUsed) < size){
+    glyph_t *old = leastUsed(g);
+    if(!old || !old->font){                                     // Only empty entries left, but no space. Can't happen
+      return 0;
+    }
+    removeGlyph(old);
+  }
+  g->offset = poolUsed;
+  poolUsed += size;
+  memset(&pool[g->offset], 0, size);
+  return 1;
+}
+
+// Replaces the u8g2 hvline function while decoding a glyph. The font decoder sets the glyph position and size before drawing
+static void captureHvline(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir){
+  u8g2_font_decode_t *decode = &u8g2->font_decode;
+
+  if(!capture->width){                                          // First line, set the glyph size
+    capture->width = decode->glyph_width;
+    capture->pages = (decode->glyph_height+7)/8;
+    capture->valid = allocData(capture, (uint16_t)capture->width*capture->pages);
+  }
+  if(!capture->valid || !u8g2->draw_color || dir){
+    return;
+  }
+  x -= decode->target_x;
+  y -= decode->target_y;
+  if(x+len>capture->width || y>=(capture->pages*8)){
+    freeData(capture);
+    return;
+  }
+  uint8_t *dst = &pool[capture->offset+((y/8)*capture->width)+x];
+  uint8_t mask = 1<<(y&7);
+  while(len--){
+    *dst++ |= mask;
+  }
+}
+
+// Decode the glyph into a cache entry, replacing the least used one
+static glyph_t *cacheGlyph(u8g2_t *u8g2, uint16_t encoding){
+  glyph_t *g = leastUsed(NULL);
+  removeGlyph(g);
+  memset(g, 0, sizeof(glyph_t));
+  g->font = u8g2->font;
+  g->encoding = encoding;
+
+  const u8g2_uint_t posX=16, posY=0;                             // Draw inside the screen, so u8g2 doesn't clip anything
+  u8g2_uint_t baseline = posY + u8g2->font_calc_vref(u8g2);
+  u8g2_draw_ll_hvline_cb hvline = u8g2->ll_hvline;
+  uint8_t color = u8g2->draw_color;
+
+  capture = g;
+  u8g2->ll_hvline = captureHvline;
+  u8g2->draw_color = 1;
+  g->dx = u8g2_DrawGlyph(u8g2, posX, posY, encoding);
+  u8g2->ll_hvline = hvline;
+  u8g2->draw_color = color;
+
+  if(!g->width){                                                // Empty glyph (space), only dx is used
+    g->valid = 1;
+  }
+  else{
+    u8g2_font_decode_t *decode = &u8g2->font_decode;
+    if((decode->target_x+g->width) > u8g2->width || (decode->target_y+decode->glyph_height) > u8g2->height){
+      freeData(g);                                              // Clipped, the data is not complete
+    }
+    g->x = decode->target_x - posX;
+    g->y = decode->target_y - baseline;
+  }
+  return g;
+}
+
+static glyph_t *getGlyph(u8g2_t *u8g2, uint16_t encoding){
+  glyph_t *g = NULL;
+  useCount++;
+  for(uint8_t x=0; x<GLYPH_CACHE_ENTRIES; x++){
+    if(cache[x].font==u8g2->font && cache[x].encoding==encoding){
+      g = &cache[x];
+      break;
+    }
+  }
+  if(!g){
+    g = cacheGlyph(u8g2, encoding);
+  }
+  g->lastUse = useCount;
+  return g;
+}
+
+// Same as u8g2_DrawStr, using the glyph cache for the cached fonts
+u8g2_uint_t glyphCacheDrawStr(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, const char *str){
+  if(!isCachedFont(u8g2->font) || !u8g2->font_decode.is_transparent || u8g2->font_decode.dir ||
+      u8g2->clip_x0 || u8g2->clip_y0 || u8g2->clip_x1<u8g2->width || u8g2->clip_y1<u8g2->height){
+    return u8g2_DrawStr(u8g2, x, y, str);
+  }
+  u8g2_uint_t sum = 0;
+  int16_t baseline = y + u8g2->font_calc_vref(u8g2);
+  while(*str && *str!='\n'){                                    // Same as u8x8_ascii_next
+    glyph_t *g = getGlyph(u8g2, (uint8_t)*str);
+    if(!g->valid){
+      u8g2_DrawGlyph(u8g2, x, y, (uint8_t)*str);
+    }
+    else if(g->width){
+      drawPages(u8g2, (int16_t)x+g->x, baseline+g->y, g->width, g->pages, &pool[g->offset]);
+    }
+    x += g->dx;
+    sum += g->dx;
+    str++;
+  }
+  return sum;
+}
+
+#else
+
+u8g2_uint_t glyphCacheDrawStr(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, const char *str){
+  return u8g2_DrawStr(u8g2, x, y, str);
+}
+
+#endif
@@ -0,0 +1,18 @@
+/*
+ * glyph_cache.h
+ *
+ *  Created on: Jul 22, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#ifndef GRAPHICS_GLYPH_CACHE_H_
+#define GRAPHICS_GLYPH_CACHE_H_
+
+#include "u8g2.h"
+#include "main.h"
+
+#define GLYPH_CACHE_ENTRIES   12                                // Max cached glyphs. The data size is set by GLYPH_CACHE_BYTES in board.h
+
+u8g2_uint_t glyphCacheDrawStr(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, const char *str);
+
+#endif /* GRAPHICS_GLYPH_CACHE_H_ */
@@ -0,0 +1,76 @@
+/*
+ * bitmaps.c
+ *
+ *  Generated by xbm2page, don't edit. Source images in u8g2/tools/xbm2page/assets
+ */
+
+#include "bitmaps.h"
+
+const uint8_t splashBMP[] = {
+  128, 64, BITMAP_RLE,
+  0x86, 0x00, 0x0B, 0x80, 0x80, 0xE0, 0x60, 0x30, 0x30, 0x78, 0xF8, 0xF8,
+  0xFC, 0x00, 0x00, 0x84, 0xFC, 0x82, 0xF8, 0x05, 0xF0, 0xF0, 0xE0, 0xC0,
+  0xC0, 0x80, 0xBD, 0x00, 0x02, 0x40, 0x40, 0x44, 0x81, 0x54, 0x16, 0xFE,
+  0x8F, 0xAE, 0xAF, 0xAE, 0x2F, 0xFE, 0xEF, 0xEE, 0x0F, 0xEE, 0xEF, 0xFE,
+  0x0F, 0xCE, 0xBF, 0xCE, 0x0F, 0xFE, 0x54, 0x54, 0x44, 0x44, 0x81, 0x00,
+  0x03, 0x80, 0xF0, 0xF8, 0xFE, 0x81, 0xFF, 0x05, 0xFE, 0xFC, 0xF8, 0xF8,
+  0x7C, 0x3C, 0x81, 0x1C, 0x85, 0x0C, 0x0E, 0x18, 0x31, 0x23, 0x67, 0xE7,
+  0xE7, 0x67, 0x27, 0x27, 0x67, 0xE7, 0xE4, 0xE0, 0xE0, 0x80, 0x81, 0x00,
+  0x11, 0x0C, 0x0C, 0xFC, 0xFC, 0x0C, 0x0C, 0x00, 0x00, 0xFC, 0xFC, 0x60,
+  0x60, 0xFC, 0xFC, 0x00, 0x00, 0xFC, 0xFC, 0x81, 0x6C, 0x00, 0x0C, 0x9D,
+  0x00, 0x82, 0x04, 0x04, 0x14, 0x14, 0x55, 0x55, 0xFF, 0x83, 0xFE, 0x07,
+  0x77, 0x57, 0x57, 0xAE, 0xFF, 0x37, 0x57, 0x6E, 0x81, 0xFF, 0x08, 0xFE,
+  0xFF, 0x55, 0x54, 0x50, 0x50, 0x00, 0x00, 0xF8, 0x82, 0xF9, 0x01, 0x01,
+  0x01, 0x81, 0xFF, 0x01, 0x87, 0x01, 0x82, 0x00, 0x07, 0x30, 0xFC, 0xFC,
+  0xFE, 0xFE, 0xFC, 0xFC, 0x30, 0x82, 0x00, 0x06, 0x01, 0x86, 0xFC, 0x00,
+  0x00, 0xFC, 0xFE, 0x81, 0x7F, 0x15, 0xFF, 0xFC, 0x00, 0x00, 0xE0, 0xE0,
+  0x63, 0x63, 0x60, 0x60, 0x00, 0x00, 0xE3, 0xE3, 0x60, 0x60, 0xE3, 0xE3,
+  0x00, 0x00, 0xE3, 0xE3, 0x82, 0x03, 0x01, 0x00, 0x00, 0x81, 0xE0, 0x06,
+  0x20, 0x20, 0xE0, 0x00, 0x00, 0xE0, 0xE0, 0x82, 0x60, 0x03, 0x00, 0x00,
+  0xE0, 0xE0, 0x81, 0x60, 0x22, 0xE0, 0x00, 0x00, 0x60, 0x60, 0xE0, 0xE0,
+  0x60, 0x60, 0x00, 0x00, 0xE0, 0xE1, 0xC1, 0x81, 0xE1, 0xE3, 0x0F, 0x03,
+  0xE7, 0xE3, 0x6F, 0x63, 0x67, 0x63, 0x0F, 0x03, 0x1F, 0x03, 0x7F, 0x03,
+  0x1F, 0x03, 0x07, 0x03, 0x81, 0x01, 0x81, 0x00, 0x0D, 0x0F, 0x3F, 0xFF,
+  0xCF, 0x87, 0x00, 0x00, 0x87, 0xCF, 0xFF, 0xFF, 0xF8, 0xF0, 0xE0, 0x83,
+  0x00, 0x01, 0xFD, 0xFD, 0x82, 0x00, 0x81, 0xC0, 0x06, 0xC8, 0xCF, 0xCF,
+  0xC0, 0xC0, 0xFF, 0xFC, 0x81, 0xF8, 0x03, 0x3C, 0x0C, 0x00, 0x00, 0x82,
+  0x1B, 0x0D, 0x1F, 0x1F, 0x00, 0x00, 0x1F, 0x1F, 0x18, 0x18, 0x1F, 0x1F,
+  0x00, 0x00, 0x1F, 0x1F, 0x82, 0x18, 0x01, 0x00, 0x00, 0x81, 0x1F, 0x06,
+  0x10, 0x10, 0x1F, 0x00, 0x00, 0x1F, 0x1F, 0x81, 0x1B, 0x20, 0x18, 0x00,
+  0x00, 0x1F, 0x1F, 0x01, 0x07, 0x1D, 0x19, 0x00, 0x00, 0x18, 0x18, 0x1F,
+  0x1F, 0x18, 0x18, 0x00, 0x00, 0x1F, 0x1F, 0x01, 0x03, 0x1F, 0x1F, 0x00,
+  0x00, 0x1F, 0x1F, 0x18, 0x1B, 0x1F, 0x1F, 0x91, 0x00, 0x09, 0x01, 0x03,
+  0x07, 0x0F, 0x1F, 0x3F, 0x3F, 0x1F, 0x07, 0x01, 0x84, 0x00, 0x01, 0xFF,
+  0xFF, 0x83, 0x00, 0x0A, 0x01, 0x03, 0x0F, 0x1F, 0x3F, 0x3F, 0x1F, 0x0F,
+  0x07, 0x03, 0x01, 0x83, 0x00, 0x35, 0xDF, 0xDF, 0xDB, 0xDB, 0xFB, 0xFB,
+  0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x00, 0x00, 0xFF, 0xFF,
+  0x1B, 0x1B, 0xFF, 0xFF, 0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03,
+  0x00, 0x00, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0x00, 0x00, 0xFF, 0xFF,
+  0xC3, 0xC3, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0x06, 0x0C, 0xFF, 0xFF,
+  0xB1, 0x00, 0x01, 0xFF, 0xFF, 0xC1, 0x00, 0x03, 0xB0, 0x4C, 0xB0, 0x50,
+  0xB5, 0x00, 0x04, 0x1F, 0x3F, 0x70, 0xE0, 0xC0, 0x83, 0x80, 0x00, 0x00,
+  0x82, 0xC0, 0x01, 0x00, 0xC0, 0xA1, 0xE0, 0x04, 0x00, 0xE0, 0xE0, 0xF0,
+  0x00, 0x8B, 0x80, 0x02, 0xA5, 0x1A, 0x01, 0xB9, 0x00, 0x84, 0x01, 0x00,
+  0x00, 0x82, 0x03, 0x01, 0x00, 0x03, 0xA1, 0x07, 0x04, 0x00, 0x07, 0x07,
+  0x0F, 0x00, 0x8C, 0x01, 0xA2, 0x00, };
+
+const uint8_t shakeBMP[] = {
+  9, 9, BITMAP_RLE,
+  0x0A, 0x70, 0x80, 0x30, 0x40, 0x45, 0x05, 0x19, 0x02, 0x1C, 0x00, 0x00,
+  0x81, 0x01, 0x82, 0x00, };
+
+const uint8_t tempBMP[] = {
+  10, 13, 0,
+  0x2A, 0x2A, 0x80, 0x7E, 0x01, 0xF9, 0x01, 0x7E, 0x80, 0x00, 0x00, 0x07,
+  0x08, 0x10, 0x17, 0x17, 0x17, 0x10, 0x08, 0x07, };
+
+const uint8_t voltBMP[] = {
+  6, 9, BITMAP_RLE,
+  0x06, 0x10, 0x98, 0xDC, 0x76, 0x33, 0x01, 0x01, 0x83, 0x00, };
+
+const uint8_t warningBMP[] = {
+  13, 13, 0,
+  0x00, 0x00, 0x80, 0x60, 0x18, 0x06, 0xE1, 0x06, 0x18, 0x60, 0x80, 0x00,
+  0x00, 0x18, 0x16, 0x11, 0x10, 0x10, 0x10, 0x15, 0x10, 0x10, 0x10, 0x11,
+  0x16, 0x18, };
+
@@ -0,0 +1,18 @@
+/*
+ * bitmaps.h
+ *
+ *  Generated by xbm2page, don't edit. Source images in u8g2/tools/xbm2page/assets
+ */
+
+#ifndef GRAPHICS_GUI_BITMAPS_H_
+#define GRAPHICS_GUI_BITMAPS_H_
+
+#include "bitmap.h"
+
+extern const uint8_t splashBMP[];
+extern const uint8_t shakeBMP[];
+extern const uint8_t tempBMP[];
+extern const uint8_t voltBMP[];
+extern const uint8_t warningBMP[];
+
+#endif
@@ -94,10 +94,10 @@ static void setAdjustSetpoint(int32_t *val) {
   setDebugTemp(*val);
 }
 static int cal_adjust_SaveAction(widget_t* w) {
-  systemSettings.Profile.Cal250_default = adcAtTemp[cal_250];
-  systemSettings.Profile.Cal350_default = adcAtTemp[cal_350];
-  systemSettings.Profile.Cal450_default = adcAtTemp[cal_450];
-  systemSettings.Profile.CalNTC = readColdJunctionSensorTemp_x10(mode_Celsius) / 10;
+  setProfileValue(Cal250_default, adcAtTemp[cal_250]);
+  setProfileValue(Cal350_default, adcAtTemp[cal_350]);
+  setProfileValue(Cal450_default, adcAtTemp[cal_450]);
+  setProfileValue(CalNTC, readColdJunctionSensorTemp_x10(mode_Celsius) / 10);
   return screen_edit_calibration;
 }
 static int cal_adjust_CancelAction(widget_t* w) {
@@ -196,6 +196,7 @@ static void Cal_Start_onEnter(screen_t *scr) {
   Currtip->calADC_At_250 = systemSettings.Profile.Cal250_default;
   Currtip->calADC_At_350 =  systemSettings.Profile.Cal350_default;
   Currtip->calADC_At_450 =  systemSettings.Profile.Cal450_default;
+  setTipDirty(systemSettings.Profile.currentTip);
 
   setCalState(cal_250);
 }
@@ -258,6 +259,7 @@ static void Cal_Start_OnExit(screen_t *scr) {
   Currtip->calADC_At_250 = backupCal250;
   Currtip->calADC_At_350 = backupCal350;
   Currtip->calADC_At_450 = backupCal450;
+  setTipDirty(systemSettings.Profile.currentTip);
 }
 
 static void Cal_Start_draw(screen_t *scr){
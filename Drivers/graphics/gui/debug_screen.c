@@ -79,6 +79,7 @@ static void * getCalcAt250() {
 }
 static void setCalcAt250(uint16_t *val) {
   getCurrentTip()->calADC_At_250 = *val;
+  setTipDirty(systemSettings.Profile.currentTip);
 }
 static void * getCalcAt350() {
   temp = getCurrentTip()->calADC_At_350;
@@ -86,6 +87,7 @@ static void * getCalcAt350() {
 }
 static void setCalcAt350(uint16_t *val) {
   getCurrentTip()->calADC_At_350 = *val;
+  setTipDirty(systemSettings.Profile.currentTip);
 }
 static void * getCalcAt450() {
   temp = getCurrentTip()->calADC_At_450;
@@ -93,6 +95,7 @@ static void * getCalcAt450() {
 }
 static void setCalcAt450(uint16_t *val) {
   getCurrentTip()->calADC_At_450 = *val;
+  setTipDirty(systemSettings.Profile.currentTip);
 }
 
 
@@ -144,6 +147,9 @@ void debug_screenDraw(screen_t *scr){
 
     sprintf(str, "D %04ld", (int32_t)(getPID_D()* 1000));
     u8g2_DrawStr(&u8g2,0,33,str);
+
+    sprintf(str, "F %u/%u", flashStats.maxStall/200, flashStats.skippedReads);         // Max flash stall (mS) / ADC readings skipped while saving
+    u8g2_DrawStr(&u8g2,0,50,str);
   }
 }
 
@@ -19,7 +19,7 @@ u8g2_t u8g2;
 void guiInit(void) {
 
   u8g2_SetupDisplay(&u8g2, u8x8_d_ssd1306_128x64_noname, u8x8_cad_001, u8x8_dummy_cb, u8x8_dummy_cb);  // Use 128x64 ssd1306 settings, dummy functions (u8g2 won't send data to screen)
-  u8g2_SetupBuffer(&u8g2, oled.buffer, 8, u8g2_ll_hvline_vertical_top_lsb, U8G2_R0);          //
+  u8g2_SetupBuffer(&u8g2, oled.buffer, 8, ssd1306_hvline, U8G2_R0);          //
 
   u8g2_SetFontMode(&u8g2,1);                                  // Set font transparent
   u8g2_SetFontDirection(&u8g2, 0);                            // No rotation
@@ -8,6 +8,9 @@
 #include "main_screen.h"
 #include "oled.h"
 #include "gui.h"
+#include "bitmaps.h"
+#include "dma_mem.h"
+#include "myTest.h"
 
 //-------------------------------------------------------------------------------------------------------------------------------
 // Main screen variables
@@ -17,6 +20,9 @@ static uint16_t plotData[100];
 static uint8_t plot_Index;
 static uint32_t plotTime;
 static bool plotUpdate;
+static uint8_t plotNew;                                               // Samples added since the graph was drawn
+static bool plotDrawn;                                                // The graph is on screen
+static int16_t plotSet;                                               // Set temperature the graph was drawn with
 
 static uint32_t barTime;
 
@@ -32,29 +38,6 @@ static char *tipName[TipSize];
 enum mode{  main_irontemp=0, main_disabled, main_ironstatus, main_setpoint, main_tipselect, main_setMode};
 enum{ status_running=0x20, status_standby, status_sleep, status_error };
 enum { temp_numeric, temp_graph };
-const uint8_t shakeXBM[] ={
-  9, 9,
-  0x70, 0x00, 0x80, 0x00, 0x30, 0x01, 0x40, 0x01, 0x45, 0x01, 0x05, 0x00,
-  0x19, 0x00, 0x02, 0x00, 0x1C, 0x00, };
-
-
-const uint8_t tempXBM[] ={
-  10, 13,
-  0x70, 0x00, 0x8B, 0x00, 0x88, 0x00, 0xAB, 0x00, 0xA8, 0x00, 0xAB, 0x00,
-  0xA8, 0x00, 0x24, 0x01, 0x72, 0x02, 0x72, 0x02, 0x72, 0x02, 0x04, 0x01,
-  0xF8, 0x00, };
-
-#ifdef USE_VIN
-const uint8_t voltXBM[] ={
-  6, 9,
-  0x30, 0x18, 0x0C, 0x06, 0x1F, 0x18, 0x0C, 0x06, 0x01, };
-#endif
-
-const uint8_t warningXBM[] ={
-  13, 13,
-  0x40, 0x00, 0xA0, 0x00, 0xA0, 0x00, 0x10, 0x01, 0x10, 0x01, 0x48, 0x02,
-  0x48, 0x02, 0x44, 0x04, 0x44, 0x04, 0x02, 0x08, 0x42, 0x08, 0x01, 0x10,
-  0xFF, 0x1F, };
 
 //-------------------------------------------------------------------------------------------------------------------------------
 // Main screen widgets
@@ -124,7 +107,7 @@ static void * getTemp() {
 
 static void setTip(uint8_t *val) {
   if(systemSettings.Profile.currentTip != *val){        // Tip temp uses huge font that partially overlaps other widgets
-    systemSettings.Profile.currentTip = *val;
+    setProfileValue(currentTip, *val);
     setCurrentTip(*val);
     Screen_main.refresh=screen_Erase;         // So, we must redraw the screen. Tip temp is drawed first, then the rest go on top.
   }
@@ -196,7 +179,7 @@ static void setMainWidget(widget_t* w){
 void clearActivityIcon(void){
   if(mainScr.ActivityOn){
     u8g2_SetDrawColor(&u8g2, BLACK);
-    u8g2_DrawBox(&u8g2, 0,OledHeight-shakeXBM[1], shakeXBM[0], shakeXBM[1]);
+    u8g2_DrawBox(&u8g2, 0,OledHeight-shakeBMP[1], shakeBMP[0], shakeBMP[1]);
     mainScr.ActivityOn=0;
     Iron.newActivity=0;
   }
@@ -248,9 +231,6 @@ int main_screenProcessInput(screen_t * scr, RE_Rotation_t input, RE_State_t *sta
   uint32_t currentTime = HAL_GetTick();
   uint8_t error = GetIronError();
 
-  if(mainScr.update){                          // This was set on a previous pass. We reset the flag now.
-    mainScr.update = 0;
-  }
   if((HAL_GetTick()-mainScr.updateTick)>systemSettings.settings.guiUpdateDelay){
     mainScr.update=1;                          // Update realtime readings slower than the rest of the GUI
     mainScr.updateTick=currentTime;
@@ -452,30 +432,80 @@ int main_screenProcessInput(screen_t * scr, RE_Rotation_t input, RE_State_t *sta
 }
 
 
+// Add a sample to the graph, in the display unit
+static void plotAdd(int16_t t){
+  if (t<20) t = 20;
+  if (t>500) t = 500;
+
+  plotUpdate=1;
+  plotData[plot_Index] = t;
+  if(++plot_Index>99){
+    plot_Index=0;
+  }
+  if(plotNew<100){
+    plotNew++;
+  }
+}
+
+// Plot height (0-40) of the sample x columns from the left of the graph. t is the set temperature
+static uint8_t plotHeight(uint8_t x, int16_t t, bool magnify){
+  uint8_t pos=plot_Index+x;
+  if(pos>99){ pos-=100; }                                             // Reset index if > 99
+
+  uint16_t plotV = plotData[pos];
+
+  if(magnify){                                                        // relative to t, +-20C
+    if (plotV < t-20) return 0;
+    if (plotV >= t+20) return 40;
+    return plotV-t+20;
+  }
+  if (plotV<180) return 0;
+  return (plotV-180) >> 3;                                            // divide by 8, (500-180)/8=40
+}
+
+// Scroll the plot area (x 13-112, y 16-55, pages 2-6) left in the buffer, and draw only the new samples
+static void scrollPlot(uint8_t cols, int16_t t, bool magnify){
+  uint8_t *buffer = u8g2_GetBufferPtr(&u8g2);
+  if(cols>100){ cols=100; }
+
+  dma_mem_wait();                                                     // Writing to the buffer directly
+  for(uint8_t page=2; page<7; page++){
+    uint8_t *row = &buffer[(page*OledWidth)+13];
+    memmove(row, row+cols, 100-cols);
+    memset(row+100-cols, 0, cols);
+  }
+  u8g2_SetDrawColor(&u8g2, WHITE);
+  for(uint8_t x=100-cols; x<100; x++){
+    uint8_t plotV = plotHeight(x, t, magnify);
+    u8g2_DrawVLine(&u8g2, x+13, 56-plotV, plotV);                     // data points
+  }
+}
+
 void main_screen_draw(screen_t *scr){
   uint8_t scr_refresh;
   static uint32_t lastState = 0;
   uint32_t currentState = (uint32_t)Iron.Error.Flags<<24 | (uint32_t)mainScr.ironStatus<<16 | mainScr.currentMode;    // Simple method to detect changes
+  bool graph = (mainScr.ironStatus==status_running && mainScr.currentMode==main_irontemp && mainScr.displayMode==temp_graph);
+  int16_t plotT = Iron.CurrentSetTemperature;
 
   uint16_t plot_t = (systemSettings.Profile.readPeriod+1)/200;                                                         // Update at the same rate as the system pwm
   if(plot_t<20){ plot_t = 20; }
   if(mainScr.currentMode!=main_disabled && (HAL_GetTick()-plotTime)>plot_t){                                          // Only store values if running
-    plotUpdate=1;
     plotTime=HAL_GetTick();
     int16_t t = readTipTemperatureCompensated(stored_reading,read_Avg);
     if(systemSettings.settings.tempUnit==mode_Farenheit){
       t = TempConversion(t, mode_Celsius, 0);
     }
-
-    if (t<20) t = 20;
-    if (t>500) t = 500;
-
-    plotData[plot_Index] = t;
-    if(++plot_Index>99){
-      plot_Index=0;
-    }
+    plotAdd(t);
   }
-  if((lastState!=currentState) || Widget_SetPoint.refresh || Widget_IronTemp.refresh || plotUpdate){
+  if(systemSettings.settings.tempUnit==mode_Farenheit){
+    plotT = TempConversion(plotT, mode_Celsius, 0);
+  }
+  if(!graph){
+    plotDrawn=0;
+  }
+  bool plotScroll = plotDrawn && plotSet==plotT;                                                                      // The graph is on screen, new samples can be scrolled in
+  if((lastState!=currentState) || Widget_SetPoint.refresh || Widget_IronTemp.refresh || (plotUpdate && !plotScroll)){
     lastState=currentState;
     scr->refresh=screen_Erase;
   }
@@ -515,11 +545,11 @@ void main_screen_draw(screen_t *scr){
     u8g2_SetDrawColor(&u8g2, WHITE);
 
     #ifdef USE_NTC
-    u8g2_DrawXBMP(&u8g2, Widget_AmbTemp.posX-tempXBM[0]-2, 0, tempXBM[0], tempXBM[1], &tempXBM[2]);
+    drawBitmap(&u8g2, Widget_AmbTemp.posX-tempBMP[0]-2, 0, tempBMP);
     #endif
 
     #ifdef USE_VIN
-    u8g2_DrawXBMP(&u8g2, 0, 2, voltXBM[0], voltXBM[1], &voltXBM[2]);
+    drawBitmap(&u8g2, 0, 2, voltBMP);
     #endif
 
     if(mainScr.currentMode==main_disabled){
@@ -566,7 +596,7 @@ void main_screen_draw(screen_t *scr){
         u8g2_DrawStr(&u8g2, Slp_xpos, Slp_ypos, "SLEEP");
         u8g2_SetFont(&u8g2, u8g2_font_labels);
         if(!Iron.Error.Flags && readTipTemperatureCompensated(0,0)>120){
-          u8g2_DrawXBMP(&u8g2, 42,0, warningXBM[0], warningXBM[1], &warningXBM[2]);
+          drawBitmap(&u8g2, 42,0, warningBMP);
           u8g2_DrawStr(&u8g2, 55, 2, "HOT!");
         }
       }
@@ -577,7 +607,7 @@ void main_screen_draw(screen_t *scr){
         putStrAligned("TIP SELECTION", 16, align_center);
       }
       if(mainScr.ActivityOn){
-        u8g2_DrawXBMP(&u8g2, 57, 2, shakeXBM[0], shakeXBM[1], &shakeXBM[2]);
+        drawBitmap(&u8g2, 57, 2, shakeBMP);
       }
     }
   }
@@ -597,64 +627,87 @@ void main_screen_draw(screen_t *scr){
       u8g2_DrawRFrame(&u8g2, 13, OledHeight-6, 100, 5, 2);
     }
 
-    if((scr_refresh || plotUpdate) && mainScr.currentMode==main_irontemp && mainScr.displayMode==temp_graph){
+    if((scr_refresh || plotUpdate) && graph){
       plotUpdate=0;
       uint8_t set;
-      int16_t t = Iron.CurrentSetTemperature;
-
       bool magnify = true;                                            // for future, to support both graph types
 
-      if(systemSettings.settings.tempUnit==mode_Farenheit){
-        t = TempConversion(t, mode_Celsius, 0);
+      if(!scr_refresh){                                               // Only new samples, scroll the plot
+        scrollPlot(plotNew, plotT, magnify);
       }
+      else{
+        plotDrawn=1;
+        plotSet=plotT;
 
-      // plot is 16-56 V, 14-113 H ?
-      u8g2_DrawVLine(&u8g2, 11, 16, 41);                              // left scale
+        // plot is 16-56 V, 14-113 H ?
+        u8g2_DrawVLine(&u8g2, 11, 16, 41);                            // left scale
 
-      if (magnify) {                                                  // graphing magnified
-        for(uint8_t y=16; y<57; y+=10){
-          u8g2_DrawHLine(&u8g2, 7, y, 4);                             // left ticks
-        }
-
-        for(uint8_t x=0; x<100; x++){
-          uint8_t pos=plot_Index+x;
-          if(pos>99){ pos-=100; }                                     // Reset index if > 99
-
-          uint16_t plotV = plotData[pos];
-
-          if (plotV < t-20) plotV = 0;
-          else if (plotV >= t+20) plotV = 40;
-          else plotV = (plotV-t+20) ;                                 // relative to t, +-20C
-          u8g2_DrawVLine(&u8g2, x+13, 56-plotV, plotV);               // data points
-        }
-        set= 36;
+        if (magnify) {                                                // graphing magnified
+          for(uint8_t y=16; y<57; y+=10){
+            u8g2_DrawHLine(&u8g2, 7, y, 4);                           // left ticks
+          }
+          set= 36;
 
-      } else {                                                        // graphing full range
-        for(uint8_t y=16; y<57; y+=13){
-          u8g2_DrawHLine(&u8g2, 7, y, 4);                             // left ticks
+        } else {                                                      // graphing full range
+          for(uint8_t y=16; y<57; y+=13){
+            u8g2_DrawHLine(&u8g2, 7, y, 4);                           // left ticks
+          }
+          if(plotT<188){ set = 1; }
+          else {
+            set=(plotT-180)>>3;
+          }
+          set= 56-set;
         }
-
         for(uint8_t x=0; x<100; x++){
-          uint8_t pos=plot_Index+x;
-          if(pos>99) pos-=100;
-
-          uint16_t plotV = plotData[pos];
-
-          if (plotV<180) plotV = 0;
-          else plotV = (plotV-180) >> 3;                              // divide by 8, (500-180)/8=40
+          uint8_t plotV = plotHeight(x, plotT, magnify);
           u8g2_DrawVLine(&u8g2, x+13, 56-plotV, plotV);               // data points
         }
-        if(t<188){ set = 1; }
-        else {
-          set=(t-180)>>3;
-        }
-        set= 56-set;
+
+        u8g2_DrawTriangle(&u8g2, 122, set-4, 122, set+4, 115, set);   // set temp marker
       }
+      plotNew=0;
+    }
+  }
+  mainScr.update = 0;                          // Readings taken by the widgets. Cleared after drawing, frames don't run on every input pass
+}
 
-      u8g2_DrawTriangle(&u8g2, 122, set-4, 122, set+4, 115, set);     // set temp marker
+#ifdef RUN_MY_TEST
+// Display benchmark (myTest.c). Draws the running main screen with the normal code, the temperature or the graph.
+// The iron is kept in safe mode there, so the status and the readings are set here instead of main_screenProcessInput().
+void main_screen_bench(uint16_t frame, bool graph){
+  if(!frame){
+    mainScr.ironStatus = status_running;
+    mainScr.currentMode = main_irontemp;
+    mainScr.displayMode = graph ? temp_graph : temp_numeric;
+    if(graph){
+      widgetDisable(&Widget_IronTemp);
     }
+    else{
+      widgetEnable(&Widget_IronTemp);
+    }
+    memset(plotData,0,sizeof(plotData));
+    plot_Index=0;
+    plotNew=0;
+    plotDrawn=0;
+    Screen_main.refresh=screen_Erase;
   }
+  mainScr.update = 0;                          // Keep the readings set here
+  mainScr.lastTip = 320+((frame/8)%10);        // Temperature changes every 8 frames
+  mainScr.lastPwr = frame%100;
+  plotTime = HAL_GetTick();                    // No real samples
+  if(graph){
+    int16_t t = Iron.CurrentSetTemperature;
+    uint8_t v = frame%40;                      // Triangle wave around the set temperature, one sample per frame
+    if(v>=20){ v = 39-v; }
+    if(systemSettings.settings.tempUnit==mode_Farenheit){
+      t = TempConversion(t, mode_Celsius, 0);
+    }
+    plotAdd(t-20+(v*2));
+  }
+  Screen_main.update(&Screen_main);
+  main_screen_draw(&Screen_main);
 }
+#endif
 
 
 //-------------------------------------------------------------------------------------------------------------------------------
@@ -664,7 +717,7 @@ void main_screen_setup(screen_t *scr) {
 
   //
   for(int x = 0; x < TipSize; x++) {
-    tipName[x] = systemSettings.Profile.tip[x].name;
+    tipName[x] = getProfileTipName(x);
   }
 
   screen_setDefaults(scr);
@@ -718,7 +771,7 @@ void main_screen_setup(screen_t *scr) {
   dis->textAlign=align_center;
   dis->number_of_dec=1;
   dis->font=u8g2_font_labels;
-  w->posX = voltXBM[0]+2;
+  w->posX = voltBMP[0]+2;
   w->posY= 2;
   dis->getData = &main_screen_getVin;
   //w->width = 40;
@@ -16,6 +16,7 @@ extern screen_t Screen_main;
 
 void main_screen_setup(screen_t *scr);
 void main_screen_draw(screen_t *scr);
+void main_screen_bench(uint16_t frame, bool graph);                   // Only built with RUN_MY_TEST
 extern volatile uint16_t seconds2;
 extern volatile uint16_t count;
 #endif /* GRAPHICS_GUI_MAIN_SCREEN_H_ */
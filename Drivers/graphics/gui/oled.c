@@ -16,6 +16,40 @@ static RE_State_t* RE_State;
 RE_Rotation_t (*RE_GetData)(RE_State_t*);
 RE_Rotation_t RE_Rotation;
 
+frameStats_t frameStats;
+static struct{
+  uint32_t lastFrame;                                   // Time of the last frame
+  uint32_t lastInput;                                   // Time of the last encoder activity
+  uint32_t fpsTime;
+  uint16_t fpsCount;
+  bool     pending;                                     // A frame is due but was postponed
+}frame;
+
+#ifdef OLED_PROFILE
+// Draw time of each screen, to compare rendering changes with real use: Idle, heating with the graph, errors, scrolling the menus...
+// The draw time doesn't include the update function or sending the frame. Printed as averages per frame, by index in the screen enum (screen.h).
+static struct{
+  uint32_t frames;
+  uint32_t time;                                        // uS
+  uint32_t maxTime;
+}profile[screen_debug2+1];
+static uint32_t profileTime;
+
+static void profilePrint(void){
+  if((HAL_GetTick()-profileTime)<OLED_PROFILE_TIME){
+    return;
+  }
+  profileTime=HAL_GetTick();
+  for(uint8_t x=0; x<=screen_debug2; x++){
+    uint32_t frames = profile[x].frames;
+    if(frames){
+      printf("SCREEN %2u  Frames:%5lu  Draw:%6luuS (Max %6lu)\n", x, frames, profile[x].time/frames, profile[x].maxTime);
+    }
+  }
+  memset(profile, 0, sizeof(profile));
+}
+#endif
+
 
 void oled_addScreen(screen_t *screen, uint8_t index) {
   screen->index = index;
@@ -41,9 +75,23 @@ void oled_addScreen(screen_t *screen, uint8_t index) {
 
 void oled_draw() {
 
-  if(oled.status!=oled_idle) { return; }                // If Oled busy, skip update
+  if(oledBufferBusy()) { return; }                      // If Oled busy, skip update
 
+#ifdef OLED_PROFILE
+  uint32_t start = getMicros();
+  current_screen->draw(current_screen);
+  if(current_screen->index<=screen_debug2){
+    uint32_t time = getMicros()-start;
+    uint8_t x = current_screen->index;
+    profile[x].frames++;
+    profile[x].time += time;
+    if(time>profile[x].maxTime){
+      profile[x].maxTime = time;
+    }
+  }
+#else
   current_screen->draw(current_screen);
+#endif
   update_display();
 }
 
@@ -94,7 +142,50 @@ void oled_processInput(void) {
     }
   }
 }
+// Returns 1 when it's time to render a frame
+static bool frameDue(void){
+  uint32_t now = HAL_GetTick();
+  uint32_t interval = ((now-frame.lastInput)<OLED_ACTIVE_TIME) ? (1000/OLED_ACTIVE_FPS) : (1000/OLED_IDLE_FPS);
+
+  if((now-frame.lastFrame)<interval){
+    return 0;
+  }
+  if(ADC_Status!=ADC_Idle || oledBufferBusy()){         // Don't start a frame while the iron is being measured, or the display is still busy
+    if(!frame.pending){
+      frame.pending=1;
+      frameStats.drops++;
+    }
+    return 0;
+  }
+  frame.pending=0;
+  frame.lastFrame=now;
+  return 1;
+}
+
+// Frame scheduler. The input is processed every time, the screen is rendered at OLED_ACTIVE_FPS while using the encoder, OLED_IDLE_FPS otherwise.
 void oled_handle(void){
   oled_processInput();
+  if(RE_Rotation!=Rotate_Nothing){
+    frame.lastInput=HAL_GetTick();
+  }
+  if(!frameDue()){
+    return;
+  }
+  uint32_t start = getMicros();
   oled_update();
+  uint32_t time = getMicros()-start;
+  frameStats.renderTime = (time>UINT16_MAX) ? UINT16_MAX : time;
+  if(frameStats.renderTime>frameStats.maxRenderTime){
+    frameStats.maxRenderTime = frameStats.renderTime;
+  }
+  frameStats.frames++;
+  frame.fpsCount++;
+  if((HAL_GetTick()-frame.fpsTime)>999){
+    frame.fpsTime=HAL_GetTick();
+    frameStats.fps=frame.fpsCount;
+    frame.fpsCount=0;
+  }
+#ifdef OLED_PROFILE
+  profilePrint();
+#endif
 }
@@ -10,6 +10,26 @@
 
 #include "screen.h"
 
+#ifndef OLED_ACTIVE_FPS
+#define OLED_ACTIVE_FPS     50                          // Frame rate while the encoder is being used
+#endif
+#ifndef OLED_IDLE_FPS
+#define OLED_IDLE_FPS       20                          // Frame rate otherwise
+#endif
+#define OLED_ACTIVE_TIME    1000                        // Time after the last encoder activity to drop to the idle rate (mS)
+#define OLED_PROFILE_TIME   5000                        // With OLED_PROFILE, print the stats of the screens used in this time (mS)
+
+typedef struct{
+  uint32_t frames;                                      // Rendered frames
+  uint32_t drops;                                       // Frames postponed because the iron was being measured or the display was busy
+  uint16_t fps;                                         // Rendered frames in the last second
+  uint16_t renderTime;                                  // Time to update, draw and send the last frame (uS). Only drawing in DMA mode
+  uint16_t maxRenderTime;
+}frameStats_t;
+
+extern frameStats_t frameStats;
+
+
 void oled_addScreen(screen_t *screen, uint8_t index);
 void oled_draw(void);
 void oled_init(RE_Rotation_t (*Rotation)(RE_State_t*), RE_State_t *State);
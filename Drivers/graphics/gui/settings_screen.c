@@ -206,7 +206,7 @@ static void * getMaxPower() {
   return &temp;
 }
 static void setMaxPower(uint32_t *val) {
-  systemSettings.Profile.power = *val;
+  setProfileValue(power, *val);
 }
 
 static void * getTipImpedance() {
@@ -214,12 +214,12 @@ static void * getTipImpedance() {
   return &temp;
 }
 static void setTipImpedance(uint32_t *val) {
-  systemSettings.Profile.impedance = *val;
+  setProfileValue(impedance, *val);
 }
 #endif
 
 static void setSleepTime(uint32_t *val) {
-  systemSettings.Profile.sleepTimeout= *val;
+  setProfileValue(sleepTimeout, *val);
 }
 static void * getSleepTime() {
   temp = systemSettings.Profile.sleepTimeout;
@@ -228,7 +228,7 @@ static void * getSleepTime() {
 
 
 static void setStandbyTime(uint32_t *val) {
-  systemSettings.Profile.standbyTimeout= *val;
+  setProfileValue(standbyTimeout, *val);
 }
 static void * getStandbyTime() {
   temp = systemSettings.Profile.standbyTimeout;
@@ -236,7 +236,7 @@ static void * getStandbyTime() {
 }
 
 static void setStandbyTemp(uint32_t *val) {
-  systemSettings.Profile.standbyTemperature= *val;
+  setProfileValue(standbyTemperature, *val);
 }
 static void * getStandbyTemp() {
   temp = systemSettings.Profile.standbyTemperature;
@@ -310,34 +310,20 @@ static void setCal450(int32_t *val) {
 }
 
 static int IRONTIPS_Save(widget_t *w) {
+  setTipData(Selected_Tip, &tipCfg);                                                                            // Might save the profile first, can't disable the interrupts
   __disable_irq();
-  systemSettings.Profile.tip[Selected_Tip] = tipCfg;
   if(Selected_Tip==systemSettings.Profile.currentTip){
     setupPID(&tipCfg.PID);
     resetPID();
   }
   else if(Selected_Tip==systemSettings.Profile.currentNumberOfTips){
-    systemSettings.Profile.currentNumberOfTips++;
+    setProfileValue(currentNumberOfTips, systemSettings.Profile.currentNumberOfTips+1);
   }
   __enable_irq();
   return comboitem_IRONTIPS_Settings_Cancel.action_screen;
 }
 static int IRONTIPS_Delete(widget_t *w) {
-  char name[TipCharSize]=_BLANK_TIP;
-  systemSettings.Profile.currentNumberOfTips--;                                                                 // Decrease the number of tips in the system
-
-
-  for(int x = Selected_Tip; x < TipSize-1;x++) {                                                                // Overwrite selected tip and move the rest one position backwards
-    systemSettings.Profile.tip[x] = systemSettings.Profile.tip[x+1];
-  }
-
-  for(int x = systemSettings.Profile.currentNumberOfTips; x < TipSize;x++) {                                    // Fill the unused tips with blank names
-    strcpy(systemSettings.Profile.tip[x].name, name);
-  }
-
-  if(systemSettings.Profile.currentTip >= systemSettings.Profile.currentNumberOfTips){                          // Check the system tip is not pointing to a blank slot
-    systemSettings.Profile.currentTip = systemSettings.Profile.currentNumberOfTips-1;                           // Select the previous tip in the list if so
-  }
+  deleteTip(Selected_Tip);                                                                                      // Remove the tip and move the rest one position backwards
                                                                                                                 // Skip tip settings (As tip is now deleted)
   return comboitem_IRONTIPS_Settings_Cancel.action_screen;                                                      // And return to main screen or system menu screen
 }
@@ -393,7 +379,7 @@ static void * getMaxTemp() {
   return &temp;
 }
 static void setMaxTemp(uint32_t *val) {
-  systemSettings.Profile.MaxSetTemperature=*val;
+  setProfileValue(MaxSetTemperature, *val);
 }
 
 static void * getMinTemp() {
@@ -404,7 +390,7 @@ static void * getMinTemp() {
 }
 
 static void setMinTemp(uint32_t *val) {
-  systemSettings.Profile.MinSetTemperature=*val;
+  setProfileValue(MinSetTemperature, *val);
 }
 
 static void * getTmpUnit() {
@@ -421,7 +407,7 @@ static void * getTmpStep() {
   return &temp;
 }
 static void setTmpStep(uint32_t *val) {
-  systemSettings.settings.tempStep = *val;
+  setSettingsValue(tempStep, *val);
 }
 
 static void * getContrast_() {
@@ -429,7 +415,7 @@ static void * getContrast_() {
   return &temp;
 }
 static void setContrast_(uint32_t *val) {
-  systemSettings.settings.contrast=*val;
+  setSettingsValue(contrast, *val);
   setContrast(*val);
 }
 
@@ -438,7 +424,7 @@ static void * getOledOffset() {
   return &temp;
 }
 static void setOledOffset(uint32_t *val) {
-  systemSettings.settings.OledOffset= * val;
+  setSettingsValue(OledOffset, *val);
 }
 
 static void * getOledDimming() {
@@ -446,7 +432,7 @@ static void * getOledDimming() {
   return &temp;
 }
 static void setOledDimming(uint32_t *val) {
-  systemSettings.settings.screenDimming = * val;
+  setSettingsValue(screenDimming, *val);
 }
 
 
@@ -455,7 +441,7 @@ static void * getActiveDetection() {
   return &temp;
 }
 static void setActiveDetection(uint32_t *val) {
-  systemSettings.settings.activeDetection = * val;
+  setSettingsValue(activeDetection, *val);
 }
 
 static void * getWakeMode() {
@@ -467,7 +453,7 @@ static void * getWakeMode() {
   return &temp;
 }
 static void setWakeMode(uint32_t *val) {
-  systemSettings.settings.WakeInputMode = *val;
+  setSettingsValue(WakeInputMode, *val);
 }
 
 static void * getStandMode() {
@@ -475,7 +461,7 @@ static void * getStandMode() {
   return &temp;
 }
 static void setStandMode(uint32_t *val) {
-  systemSettings.settings.StandMode = *val;
+  setSettingsValue(StandMode, *val);
 }
 
 static void * getEncoderMode() {
@@ -484,7 +470,7 @@ static void * getEncoderMode() {
   return &temp;
 }
 static void setEncoderMode(uint32_t *val) {
-  systemSettings.settings.EncoderMode = * val;
+  setSettingsValue(EncoderMode, *val);
 }
 
 static void * getGuiUpd_ms() {
@@ -492,7 +478,7 @@ static void * getGuiUpd_ms() {
   return &temp;
 }
 static void setGuiUpd_ms(uint32_t *val) {
-  systemSettings.settings.guiUpdateDelay = *val;
+  setSettingsValue(guiUpdateDelay, *val);
 
 }
 
@@ -501,7 +487,7 @@ static void * getSavDelay() {
   return &temp;
 }
 static void setSavDelay(uint32_t *val) {
-  systemSettings.settings.saveSettingsDelay = *val;
+  setSettingsValue(saveSettingsDelay, *val);
 }
 
 static void * getLVP() {
@@ -509,7 +495,7 @@ static void * getLVP() {
   return &temp;
 }
 static void setLVP(uint32_t *val) {
-  systemSettings.settings.lvp = *val;
+  setSettingsValue(lvp, *val);
 }
 
 static void * geterrorDelay() {
@@ -517,7 +503,7 @@ static void * geterrorDelay() {
   return &temp;
 }
 static void enableDelay(uint32_t *val) {
-  systemSettings.settings.errorDelay = *val;
+  setSettingsValue(errorDelay, *val);
 }
 
 static void * getNoIronADC() {
@@ -525,21 +511,21 @@ static void * getNoIronADC() {
   return &temp;
 }
 static void setNoIronADC(uint32_t *val) {
-  systemSettings.Profile.noIronValue = *val;
+  setProfileValue(noIronValue, *val);
 }
 static void * getbuzzerMode() {
   temp = systemSettings.settings.buzzerMode;
   return &temp;
 }
 static void setbuzzerMode(uint32_t *val) {
-  systemSettings.settings.buzzerMode = *val;
+  setSettingsValue(buzzerMode, *val);
 }
 static void * getInitMode() {
   temp = systemSettings.settings.initMode;
   return &temp;
 }
 static void setInitMode(uint32_t *val) {
-  systemSettings.settings.initMode = *val;
+  setSettingsValue(initMode, *val);
 }
 
 static void * getfilterFactor() {
@@ -547,7 +533,7 @@ static void * getfilterFactor() {
   return &temp;
 }
 static void setfilterFactor(uint32_t *val) {
-  systemSettings.Profile.filterFactor = *val;
+  setProfileValue(filterFactor, *val);
 }
 
 static void * getProfile() {
@@ -601,7 +587,7 @@ static int doFactoryReset(void) {
 }
 
 static void setButtonWake(uint32_t *val) {
-  systemSettings.settings.wakeOnButton = *val;
+  setSettingsValue(wakeOnButton, *val);
 }
 static void * getButtonWake() {
   temp = systemSettings.settings.wakeOnButton;
@@ -609,7 +595,7 @@ static void * getButtonWake() {
 }
 
 static void setShakeWake(uint32_t *val) {
-  systemSettings.settings.wakeOnShake = *val;
+  setSettingsValue(wakeOnShake, *val);
 }
 static void * getShakeWake() {
   temp = systemSettings.settings.wakeOnShake;
@@ -717,7 +703,7 @@ static void iron_tips_screen_init(screen_t *scr) {
   comboBox_item_t *i = comboBox_IRONTIPS.first;
   for(int x = 0; x < TipSize; x++) {
     if(x < systemSettings.Profile.currentNumberOfTips) {
-      i->text = systemSettings.Profile.tip[x].name;
+      i->text = getProfileTipName(x);
       i->enabled = 1;
     }
     else
@@ -748,7 +734,7 @@ void IRONTIPS_Settings_onEnter(screen_t *scr){
   else if(scr==&Screen_iron_tips){                                                                      // If coming from tips menu
     if(comboBox_IRONTIPS.currentItem == &comboitem_IRONTIPS_addNewTip) {                                // If was Add New tip option
       for(uint8_t x = 0; x < TipSize; x++) {                                                            // Find first valid tip and store the position
-        if(strcmp(systemSettings.Profile.tip[x].name, _BLANK_TIP)!=0){
+        if(strcmp(getProfileTipName(x), _BLANK_TIP)!=0){
           Selected_Tip=x;
           new=1;
           break;
@@ -760,7 +746,7 @@ void IRONTIPS_Settings_onEnter(screen_t *scr){
     }
     else{
       for(uint8_t x = 0; x < TipSize; x++) {                                                            // Else, find the selected tip
-        if(strcmp(comboBox_IRONTIPS.currentItem->text, systemSettings.Profile.tip[x].name)==0){
+        if(strcmp(comboBox_IRONTIPS.currentItem->text, getProfileTipName(x))==0){
           Selected_Tip = x;
         }
       }
@@ -768,7 +754,7 @@ void IRONTIPS_Settings_onEnter(screen_t *scr){
     comboitem_IRONTIPS_Settings_Cancel.action_screen = screen_iron_tips;
   }
 
-  tipCfg = systemSettings.Profile.tip[Selected_Tip];                                                      // Copy selected tip
+  getTipData(Selected_Tip, &tipCfg);                                                                      // Copy selected tip
 
   if(new){                                                                                                // If new tip selected
     strcpy(tipCfg.name, _BLANK_TIP);                                                                      // Set an empty name
@@ -823,7 +809,7 @@ int IRONTIPS_Settings_ProcessInput(screen_t * scr, RE_Rotation_t input, RE_State
     }
     else{
       for(uint8_t x = 0; x < TipSize; x++) {                                                                    // Compare tip names with current edit
-        if( (strcmp(tipCfg.name, systemSettings.Profile.tip[x].name) == 0) && x!=Selected_Tip ){                // If match is found, and it's not the tip being edited
+        if( (strcmp(tipCfg.name, getProfileTipName(x)) == 0) && x!=Selected_Tip ){                              // If match is found, and it's not the tip being edited
           enable=0;                                                                                             // Disable save button
           break;
         }
@@ -858,7 +844,7 @@ void SYSTEM_onEnter(screen_t *scr){
   if(scr!=&Screen_reset){
     comboResetIndex(&comboWidget_SYSTEM);
   }
-  if(ChecksumProfile(&systemSettings.Profile)!=systemSettings.ProfileChecksum){         // If there's unsaved profile data
+  if(ChecksumProfile(&systemSettings.Profile, getTipData)!=systemSettings.ProfileChecksum){   // If there's unsaved profile data
     saveSettingsFromMenu(save_Settings);                                                // Save settings
   }
   profile=systemSettings.settings.currentProfile;
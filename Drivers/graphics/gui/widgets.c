@@ -9,6 +9,8 @@
 #include "screen.h"
 #include "oled.h"
 #include "gui.h"
+#include "glyph_cache.h"
+#include "width_cache.h"
 static char displayString[32];
 static bool callFromCombo;
 
@@ -114,7 +116,7 @@ void widgetDefaultsInit(widget_t *w, widgetType t, void* content){
     dis->number_of_dec = 0;
     dis->type = field_int32;
     dis->displayString=displayString;
-    dis->endString=NULL;
+    dis->endString="";                                 // Appended without checking, can't be NULL
     dis->stringStart=0;
     dis->last_value = 0;
     dis->textAlign = align_center;
@@ -387,21 +389,21 @@ void widgetAlign(widget_t* w){
   switch(w->type){
     case widget_button:
       button = (button_widget_t *)w->content;
-      strWidth=u8g2_GetStrWidth(&u8g2, button->displayString);
+      strWidth=cachedStrWidth(&u8g2, button->displayString);
       break;
 
     case widget_display:
     case widget_editable:
       if(dis->type == field_string){
-        strWidth=u8g2_GetStrWidth(&u8g2, (char *)dis->getData());
+        strWidth=cachedStrWidth(&u8g2, (char *)dis->getData());
       }
       else{
-        strWidth=u8g2_GetStrWidth(&u8g2, displayString);
+        strWidth=cachedStrWidth(&u8g2, displayString);
       }
       break;
 
     case widget_multi_option:
-      strWidth=u8g2_GetStrWidth(&u8g2,  (char *)edit->options[*(uint8_t*)dis->getData()]);
+      strWidth=cachedStrWidth(&u8g2,  (char *)edit->options[*(uint8_t*)dis->getData()]);
       break;
     default:
       return;
@@ -616,16 +618,16 @@ void default_widgetDraw(widget_t *w) {
 
       case widget_display:
         if(dis->type == field_string){
-          u8g2_DrawStr(&u8g2, dis->stringStart, w->posY,  dis->getData());
+          glyphCacheDrawStr(&u8g2, dis->stringStart, w->posY,  dis->getData());
         }
         else{
-          u8g2_DrawStr(&u8g2, dis->stringStart, w->posY,  dis->displayString);
+          glyphCacheDrawStr(&u8g2, dis->stringStart, w->posY,  dis->displayString);
         }
         break;
 
       case widget_editable:
         if(dis->type == field_string){
-          u8g2_DrawStr(&u8g2,  dis->stringStart, w->posY+2,  dis->getData());
+          glyphCacheDrawStr(&u8g2,  dis->stringStart, w->posY+2,  dis->getData());
           if(sel->state == widget_edit){
             char t[20];
             strcpy(t,dis->getData());
@@ -649,7 +651,7 @@ void default_widgetDraw(widget_t *w) {
           }
         }
         else{
-          u8g2_DrawStr(&u8g2,dis->stringStart, w->posY+2,  dis->displayString);
+          glyphCacheDrawStr(&u8g2,dis->stringStart, w->posY+2,  dis->displayString);
         }
         break;
 
@@ -748,7 +750,7 @@ void comboBoxDraw(widget_t *w) {
         u8g2_DrawStr(&u8g2, 4, y * height + w->posY +2, item->text);
       }
       else{
-        uint8_t len = u8g2_GetStrWidth(&u8g2, item->text);
+        uint8_t len = cachedStrWidth(&u8g2, item->text);
         if(item->dispAlign==align_right){
           u8g2_DrawStr(&u8g2, OledWidth-3-len, y * height + w->posY +2, item->text);
         }
@@ -774,7 +776,7 @@ void comboBoxDraw(widget_t *w) {
       }
 
       if(item->type==combo_MultiOption){
-        len = u8g2_GetStrWidth(&u8g2,edit->options[*(uint8_t*)dis->getData()]);
+        len = cachedStrWidth(&u8g2,edit->options[*(uint8_t*)dis->getData()]);
       }
       else if(item->type==combo_Editable){
         if(dis->type==field_int32){
@@ -796,11 +798,11 @@ void comboBoxDraw(widget_t *w) {
             strcat(dis->displayString, dis->endString);                       // Append endString
           }
           dis->displayString[dis->reservedChars]=0;                           // Ensure last string char is 0
-          len=u8g2_GetStrWidth(&u8g2,dis->displayString);
+          len=cachedStrWidth(&u8g2,dis->displayString);
         }
         else if(dis->type==field_string){
           strncpy(displayString,dis->getData(),dis->reservedChars+1);
-          len=u8g2_GetStrWidth(&u8g2,displayString);
+          len=cachedStrWidth(&u8g2,displayString);
         }
       }
 
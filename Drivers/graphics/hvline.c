@@ -0,0 +1,71 @@
+/*
+ * hvline.c
+ *
+ *  Created on: Jul 25, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#include "hvline.h"
+
+/*
+ * Replacement for u8g2_ll_hvline_vertical_top_lsb, for the full buffer in the SSD1306 format (Vertical bytes, LSB on top).
+ * Same result, but a horizontal line is a single mask applied to consecutive bytes of the page, 4 columns at once,
+ * and a vertical line is a mask per page instead of a pixel at a time.
+ * u8g2_DrawBox draws a horizontal line per row, so the boxes take the fast path too.
+ * The coordinates are already clipped by u8g2.
+ */
+
+// Apply the mask to len bytes, using 32-bit words for the aligned part
+static void fillSpan(uint8_t *ptr, uint16_t len, uint8_t mask, uint8_t color){
+  uint32_t mask32 = mask * 0x01010101UL;
+
+  while(len && ((uintptr_t)ptr & 3)){                            // Cortex-M0 can't do unaligned word accesses
+    if(color==1){ *ptr |= mask; }
+    else if(color==0){ *ptr &= ~mask; }
+    else{ *ptr ^= mask; }
+    ptr++;
+    len--;
+  }
+  uint32_t *word = (uint32_t*)ptr;
+  if(color==1){
+    for(; len>=4; len-=4){ *word++ |= mask32; }
+  }
+  else if(color==0){
+    for(; len>=4; len-=4){ *word++ &= ~mask32; }
+  }
+  else{
+    for(; len>=4; len-=4){ *word++ ^= mask32; }
+  }
+  ptr = (uint8_t*)word;
+  while(len--){
+    if(color==1){ *ptr |= mask; }
+    else if(color==0){ *ptr &= ~mask; }
+    else{ *ptr ^= mask; }
+    ptr++;
+  }
+}
+
+void fastHVLine(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir){
+  uint16_t width = u8g2->pixel_buf_width;
+  uint8_t *ptr = &u8g2->tile_buf_ptr[((y>>3)*width)+x];
+  uint8_t bit = y&7;
+  uint8_t color = u8g2->draw_color;
+
+  if(dir==0){
+    fillSpan(ptr, len, 1<<bit, color);
+    return;
+  }
+  while(len){                                                   // Vertical line, one mask per page
+    uint8_t rows = 8-bit;
+    if(rows>len){
+      rows = len;
+    }
+    uint8_t mask = (uint8_t)(0xFF<<bit) & (uint8_t)(0xFF>>(8-bit-rows));
+    if(color==1){ *ptr |= mask; }
+    else if(color==0){ *ptr &= ~mask; }
+    else{ *ptr ^= mask; }
+    ptr += width;
+    len -= rows;
+    bit = 0;
+  }
+}
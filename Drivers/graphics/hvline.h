@@ -0,0 +1,15 @@
+/*
+ * hvline.h
+ *
+ *  Created on: Jul 25, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#ifndef GRAPHICS_HVLINE_H_
+#define GRAPHICS_HVLINE_H_
+
+#include "u8g2.h"
+
+void fastHVLine(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+
+#endif /* GRAPHICS_HVLINE_H_ */
@@ -3,13 +3,43 @@
 #include "buzzer.h"
 #include "iron.h"
 #include "gui.h"
+#include "dma_mem.h"
+#include "hvline.h"
+#include "width_cache.h"
 
 oled_t oled = {
+#ifdef OLED_DOUBLE_BUFFER
+    .ptr =  &oled.front[0]
+#else
     .ptr =  &oled.buffer[0]
+#endif
 };
 
 static uint8_t lastContrast;
 
+// Display configuration, sent when starting. Also after an aborted background transfer (OLED_TIM_DMA)
+static const uint8_t oledConfig[] = {
+  0xD5, 0xF0,               // Set Display Clock Divide Ratio / Oscillator Frequency, max framerate
+  0xA8, 0x3F,               // Set Multiplex Ratio, Default => 0x3F (1/64 Duty)
+  0xD3, 0x00,               // Set Display Offset, Default => 0x00
+  0x40|0x00,                // Set Display Start Line
+  0x20,                     // Set Memory Addressing Mode
+#ifdef OLED_HORIZONTAL
+  0x00,                     // Horizontal, the window wraps to the next page
+#else
+  0x02,                     // Default => 0x02 (Page)
+#endif
+  0xA0|0x01,                // Set Segment Re-Map
+  0xC0|0x08,                // Set COM Output Scan Direction
+  0xDA, 0x02|0x10,          // Set COM Pins Hardware Configuration, Default => 0x12 (0x10)
+  0xD9, 0x22,               // Set Pre-Charge Period, Default => 0x22 (2 Display Clocks [Phase 2] / 2 Display Clocks [Phase 1])
+  0xDB, 0x30,               // Set VCOMH Deselect Level, Default => 0x20 (0.77*VCC)
+  0xA4|0x00,                // Set Entire Display On/Off
+  0xA6|0x00,                // Set Inverse Display On/Off
+  0x8D, 0x14,               // Set Charge Pump command, enable charge pump
+  0x33,                     // Charge pump to 9V
+};
+
 // Silicon bug workaround for STM32F103 as ST document ES093 rev 7
 /*
   __HAL_I2C_DISABLE(device);
@@ -169,8 +199,15 @@ void disable_soft_Oled(void){
 
 #if defined OLED_SPI && !defined OLED_DEVICE
 
+// Write one bit, the display latches SDA in the SCL rising edge.
+// The BSRR words are precomputed, no shifts or branches per bit.
+#define spiBit(mask)  SW_SDA_GPIO_Port->BSRR = (data & mask) ? sdaSet : sdaClr; \
+                      Oled_Set_SCL();                                           \
+                      Oled_Clear_SCL()
+
 void spi_send(uint8_t* bf, uint16_t count){
-  uint8_t shift,data;
+  const uint32_t sdaSet = SW_SDA_Pin, sdaClr = (uint32_t)SW_SDA_Pin<<16;
+  uint8_t data;
   while(count--){
     data = *bf++;
     if((data==0) || (data==0xFF)){
@@ -198,29 +235,20 @@ void spi_send(uint8_t* bf, uint16_t count){
       Oled_Clear_SCL();
     }
     else{
-      for(shift = 0; shift < 8; shift++){
-        if(data & 0x80){
-          Oled_Set_SDA();
-        }
-        else{
-          Oled_Clear_SDA();
-        }
-
-        Oled_Set_SCL();
-        data <<= 1;
-        Oled_Clear_SCL();
-      }
+      spiBit(0x80);
+      spiBit(0x40);
+      spiBit(0x20);
+      spiBit(0x10);
+      spiBit(0x08);
+      spiBit(0x04);
+      spiBit(0x02);
+      spiBit(0x01);
     }
   }
 }
 #endif
 
 #if defined OLED_I2C && (!defined OLED_DEVICE  || (defined OLED_DEVICE && defined I2C_TRY_HW))
-void i2cDelay(void){
-  asm( "nop\nnop\nnop\nnop\nnop\nnop\nnop\nnop\n\
-        nop\nnop\nnop\nnop\nnop\nnop\nnop/*\nnop\n\
-        nop\nnop\nnop\nnop\nnop\nnop\nnop\nnop*/");
-}
 void i2cStart(void){                                      // Start condition, SDA transition to low with SCL high
   Oled_Set_SCL();
   i2cDelay();
@@ -238,63 +266,62 @@ void i2cStop(void){                                       // Stop condition, SCL
   i2cDelay();
 }
 
-// This sw i2c driver is extremely timing optimized, done specially for ksger v2.1 and compatibles running at 36MHz.
-// Hacks clock low time using the slow rise time (i2c pullup resistors) as the delay.
-// Will start failing if the core runs faster than 44-48MHz because of the tight timing.
-void i2cBegin(uint8_t mode){
-  uint8_t bytes, shift, data[2]= { OLED_ADDRESS, mode };
-  uint8_t *bf=data;
-  bytes=1;
-  do{
-    shift=7;
-    do{
-    SW_SDA_GPIO_Port->BSRR = SW_SDA_Pin<<(16*!(*bf & (1<<shift)));
-      Oled_Set_SCL();
-      i2cDelay();
-      Oled_Clear_SCL();
-    }while(shift--);
+// This sw i2c driver is extremely timing optimized, done specially for ksger v2.1 and compatibles.
+// Hacks clock low time using the slow rise time (i2c pullup resistors) as the delay, the clock high time is set by i2cDelay().
+// The display is write-only, the ACK bit is clocked but never read.
+#define i2cBit(mask)  SW_SDA_GPIO_Port->BSRR = (data & mask) ? sdaSet : sdaClr; \
+                      i2cSetupDelay();                                          \
+                      Oled_Set_SCL();                                           \
+                      i2cDelay();                                               \
+                      Oled_Clear_SCL()
+
+#define i2cClock()    Oled_Set_SCL();                                           \
+                      i2cDelay();                                               \
+                      Oled_Clear_SCL()
+
+static void i2cByte(uint8_t data){
+  const uint32_t sdaSet = SW_SDA_Pin, sdaClr = (uint32_t)SW_SDA_Pin<<16;
+
+  if((data==0) || (data==0xFF)){                        // If data 0 or 0xff, we don't have to toggle data line, send the data fast
+    SW_SDA_GPIO_Port->BSRR = data ? sdaSet : sdaClr;
+    i2cClock();
+    i2cClock();
+    i2cClock();
+    i2cClock();
+    i2cClock();
+    i2cClock();
+    i2cClock();
+    i2cClock();
+  }
+  else{
+    i2cBit(0x80);
+    i2cBit(0x40);
+    i2cBit(0x20);
+    i2cBit(0x10);
+    i2cBit(0x08);
+    i2cBit(0x04);
+    i2cBit(0x02);
+    i2cBit(0x01);
+  }
+  i2cDelay();
+  Oled_Set_SCL();                                       // ACK clock
+  i2cDelay();
+  //Oled_Set_SDA();                                     // As we don't care about the ACK, don't release SDA
+  //i2cDelay();
+  //Get ACK here
+  Oled_Clear_SCL();
+}
 
-    i2cDelay();
-    Oled_Set_SCL();
-    i2cDelay();
-    //Oled_Set_SDA();                                     // As we don't care about the ACK, don't release SDA
-    //i2cDelay();
-    //Get ACK here
-    Oled_Clear_SCL();
-    bf++;
-  }while(bytes--);
+void i2cBegin(uint8_t mode){
+  i2cByte(OLED_ADDRESS);
+  i2cByte(mode);
 }
 
 void i2cSend(uint8_t* bf, uint16_t count, uint8_t mode){
-  uint8_t shift;
   i2cStart();
   i2cBegin(mode);
   while(count--){
-    shift=7;
-    if( (*bf==0)||(*bf==0xFF)){                         // If data 0 or 0xff, we don't have to toggle data line, send the data fast
-      SW_SDA_GPIO_Port->BSRR = SW_SDA_Pin<<(16*(*bf==0));
-      do{
-        Oled_Set_SCL();
-        i2cDelay();
-        Oled_Clear_SCL();
-      }while(shift--);
-    }
-    else{
-      do{
-        SW_SDA_GPIO_Port->BSRR = SW_SDA_Pin<<(16*!(*bf & (1<<shift)));
-        Oled_Set_SCL();
-        i2cDelay();
-        Oled_Clear_SCL();
-      }while(shift--);
-    }
-    i2cDelay();
-    Oled_Set_SCL();
-    i2cDelay();
-    //Oled_Set_SDA();                                   // As we don't care about the ACK, don't release SDA
-    //i2cDelay();
-    //Get ACK here
-    Oled_Clear_SCL();
-    bf++;
+    i2cByte(*bf++);
   }
   i2cStop();
 }
@@ -304,7 +331,7 @@ void i2cSend(uint8_t* bf, uint16_t count, uint8_t mode){
 // Send command in blocking mode
 void write_cmd(uint8_t cmd) {
 
-  while(oled.status==oled_busy);                          // Wait for DMA to finish
+  oledWait(oled.status==oled_busy);                        // Wait for DMA to finish
 
 #if defined OLED_SPI
   #ifdef USE_CS
@@ -353,15 +380,451 @@ void write_cmd(uint8_t cmd) {
 #endif
 }
 
+// Display RAM content is unknown, send everything in the next update
+static void invalidate_display(void){
+  for(uint8_t row=0;row<8;row++){
+    oled.segments[row]=0xFF;
+  }
+  oled.dirty=0xFF;
+}
+
+// Compare each page segment with the last sent one. Most updates only change a few digits or the power bar.
+// Uses the hardware CRC, much faster than sending the data.
+static void findDirtyPages(void){
+  if(oled.offset!=systemSettings.settings.OledOffset){    // Column offset changed, send everything
+    oled.offset=systemSettings.settings.OledOffset;
+    invalidate_display();
+  }
+  for(uint8_t row=0;row<8;row++){
+    for(uint8_t seg=0;seg<OledSegments;seg++){
+      uint32_t crc = HAL_CRC_Calculate(&hcrc, (uint32_t*)&oled.buffer[(128*row)+(seg*OledSegment)], OledSegment/sizeof(uint32_t));
+      if(crc!=oled.segmentCRC[row][seg]){
+        oled.segmentCRC[row][seg]=crc;
+        oled.segments[row] |= 1<<seg;
+      }
+    }
+    if(oled.segments[row]){
+      oled.dirty |= 1<<row;
+    }
+  }
+}
+
+#ifdef OLED_HORIZONTAL
+#define OledWindowCmd       6                             // Column and page range commands
+#define OledTransferCost    (OledWindowCmd+10)            // Overhead of each transfer in bytes (Commands, DMA setup and interrupt)
+#define OledColumns         (128-systemSettings.settings.OledOffset)  // The column range can't go past the last column (127), the rest of the page is not visible
+#else
+#define OledWindowCmd       3                             // Page and column start commands
+#endif
+
+// Column window covering the changed segments of the page. Sent as a single transfer, the position command costs more than small gaps.
+static void getPageWindow(uint8_t row, uint8_t *column, uint8_t *count){
+  uint8_t first=0, last=OledSegments-1;
+
+  while(!(oled.segments[row] & (1<<first))){
+    first++;
+  }
+  while(!(oled.segments[row] & (1<<last))){
+    last--;
+  }
+  *column = first*OledSegment;
+  *count = (last-first+1)*OledSegment;
+}
+
+#ifdef OLED_HORIZONTAL
+// Join the dirty pages into a single full width band if sending it is cheaper than the separate page windows.
+// A full frame is always sent in a single transfer.
+static void mergeDirtyPages(void){
+  uint8_t first=0, last=7, column, count;
+  uint16_t windows=0;
+
+  if(!oled.dirty || systemSettings.settings.OledOffset){  // With a column offset the pages can't be joined, each one starts at the offset
+    return;
+  }
+  for(uint8_t row=0;row<8;row++){
+    if(oled.segments[row]){
+      getPageWindow(row, &column, &count);
+      windows += count+OledTransferCost;
+    }
+  }
+  while(!(oled.dirty & (1<<first))){
+    first++;
+  }
+  while(!(oled.dirty & (1<<last))){
+    last--;
+  }
+  if((uint16_t)128*(last-first+1) <= windows){
+    for(uint8_t row=first;row<=last;row++){
+      oled.segments[row]=0xFF;
+      oled.dirty |= 1<<row;
+    }
+  }
+}
+#endif
+
+// Take the next transfer starting at row, clearing its pending segments. Returns the data length.
+// In horizontal mode, consecutive full pages are sent together.
+static uint16_t nextTransfer(uint8_t row, uint8_t *pages, uint8_t *column){
+  uint16_t count;
+  uint8_t width;
+
+  *pages=1;
+#ifdef OLED_HORIZONTAL
+  if(oled.segments[row]==0xFF && !systemSettings.settings.OledOffset){
+    while((row+*pages)<8 && oled.segments[row+*pages]==0xFF){
+      (*pages)++;
+    }
+  }
+#endif
+  if(*pages>1){
+    *column=0;
+    count=(uint16_t)128*(*pages);
+  }
+  else{
+    getPageWindow(row, column, &width);
+    count=width;
+#ifdef OLED_HORIZONTAL
+    if(*column >= OledColumns){                           // Nothing visible (Offset over a segment), just send the last visible column
+      *column = OledColumns-1;
+    }
+    if((*column+count) > OledColumns){
+      count = OledColumns-*column;
+    }
+#endif
+  }
+  for(uint8_t x=row;x<row+*pages;x++){
+    oled.segments[x]=0;
+    oled.dirty &= ~(1<<x);
+  }
+  oled.bytes += count+OledWindowCmd;
+  return count;
+}
+
+// Build the commands to set the display write window. Returns the command length.
+static uint8_t getWindowCmd(uint8_t row, uint8_t pages, uint8_t column, uint16_t count, uint8_t *cmd){
+  column += systemSettings.settings.OledOffset;
+#ifdef OLED_HORIZONTAL
+  cmd[0]=0x21;                                            // Set column range
+  cmd[1]=column;
+  cmd[2]=column+(count/pages)-1;
+  cmd[3]=0x22;                                            // Set page range
+  cmd[4]=row;
+  cmd[5]=row+pages-1;
+#else
+  (void)pages;
+  (void)count;
+  cmd[0]=0xB0|row;                                        // Set the OLED Row address
+  cmd[1]=column&0x0F;                                     // Set the column start address, lower nibble
+  cmd[2]=0x10|(column>>4);                                // Higher nibble
+#endif
+  return OledWindowCmd;
+}
+
+#ifdef OLED_TIM_DMA
+/*
+ * Background transport for software I2C displays.
+ * The I2C signals are encoded as a stream of GPIO BSRR words, written to the port by the DMA at the pace of a timer.
+ * Each bit takes 3 words: SCL low, the SDA value, then SCL high. SDA never changes in the same word as SCL, so it can't
+ * move while SCL is high whatever the edge delays are. Zero words don't change anything, used as padding.
+ * The stream is built in a small circular buffer, each half is refilled by the DMA interrupt while the other one is sent.
+ * If the interrupt comes too late the DMA sends the old half again, the frame is aborted and sent again (See timRefill).
+ * Uses TIM2 compare 2 requests, DMA1 channel 7 (STM32F1 mapping). Channel 2 (TIM2 update) is used by the fill DMA.
+ */
+#define TIM_DMA_BYTES       4                             // Bytes per half buffer
+#define TIM_DMA_SYMBOL      27                            // Max words per symbol (One byte and the ACK clock)
+#define TIM_DMA_HALF        (TIM_DMA_BYTES*TIM_DMA_SYMBOL)
+#define TIM_SCL_SET         ((uint32_t)SW_SCL_Pin)
+#define TIM_SCL_CLR         ((uint32_t)SW_SCL_Pin<<16)
+#define TIM_SDA_SET         ((uint32_t)SW_SDA_Pin)
+#define TIM_SDA_CLR         ((uint32_t)SW_SDA_Pin<<16)
+#define TIM_RECOVER_NOPS    6                             // Max parameters of a command
+
+enum { tx_recover, tx_restart, tx_start, tx_addr, tx_mode, tx_data };
+
+static struct{
+  DMA_HandleTypeDef dma;
+  uint32_t          stream[2*TIM_DMA_HALF];
+  uint8_t           cmd[OledWindowCmd];
+  const uint8_t     *ptr;                               // Bytes of the current transaction
+  uint16_t          count;
+  const uint8_t     *data;                              // Page data, sent after the window command
+  uint16_t          dataCount;
+  uint8_t           mode;
+  uint8_t           state;
+  uint8_t           done;                               // All the frame is in the stream
+  uint8_t           lastHalf;                           // Half holding the end of the frame
+  uint8_t           recover;                            // Last frame was aborted, clear the bus before the next one
+  uint8_t           config[TIM_RECOVER_NOPS+sizeof(oledConfig)+4];  // Commands sent after the bus clear
+}tim;
+
+// Set up the next transaction: the window command of the next dirty page, then its data
+static bool timNextTransaction(void){
+  uint8_t pages, column;
+
+  if(tim.data){
+    tim.mode = i2cData;
+    tim.ptr = tim.data;
+    tim.count = tim.dataCount;
+    tim.data = NULL;
+    return 1;
+  }
+  while(oled.row<8 && !(oled.dirty & (1<<oled.row))){    // Skip unchanged pages
+    oled.row++;
+  }
+  if(oled.row>7){
+    return 0;
+  }
+  tim.dataCount = nextTransfer(oled.row, &pages, &column);
+  tim.data = oled.ptr+((uint16_t)128*oled.row)+column;
+  getWindowCmd(oled.row, pages, column, tim.dataCount, tim.cmd);
+  tim.mode = i2cCmd;
+  tim.ptr = tim.cmd;
+  tim.count = OledWindowCmd;
+  oled.row += pages;
+  return 1;
+}
+
+static uint32_t *timPutByte(uint32_t *dst, uint8_t data){
+  for(uint8_t bit=0;bit<8;bit++){
+    *dst++ = TIM_SCL_CLR;
+    *dst++ = (data & 0x80) ? TIM_SDA_SET : TIM_SDA_CLR;
+    *dst++ = TIM_SCL_SET;
+    data <<= 1;
+  }
+  *dst++ = TIM_SCL_CLR;                                     // ACK clock, SDA is not released as we don't care about the ACK
+  *dst++ = TIM_SDA_CLR;
+  *dst++ = TIM_SCL_SET;
+  return dst;
+}
+
+static uint32_t *timPutStart(uint32_t *dst){                // Start condition, SDA transition to low with SCL high
+  *dst++ = TIM_SDA_SET;                                     // Both are already high after a stop
+  *dst++ = TIM_SCL_SET;
+  *dst++ = TIM_SDA_CLR;
+  return dst;
+}
+
+static uint32_t *timPutStop(uint32_t *dst){                 // Stop condition, SDA transition to high with SCL high
+  *dst++ = TIM_SCL_CLR;
+  *dst++ = TIM_SDA_CLR;
+  *dst++ = TIM_SCL_SET;
+  *dst++ = TIM_SDA_SET;
+  return dst;
+}
+
+// Fill half of the stream with the next symbols, padding the rest
+static void timFill(uint8_t half){
+  uint32_t *dst = &tim.stream[half*TIM_DMA_HALF];
+  uint32_t *end = dst+TIM_DMA_HALF;
+
+  while(!tim.done && (end-dst)>=TIM_DMA_SYMBOL){
+    switch(tim.state){
+      case tx_recover:                                      // Bus clear, the display might be left in the middle of a byte
+        dst = timPutStop(dst);                              // The partial byte is discarded
+        for(uint8_t x=0;x<9;x++){                           // If the display was holding SDA for the ACK there was no stop,
+          *dst++ = TIM_SCL_CLR;                             // clock with SDA released until it's free and stop again
+          *dst++ = TIM_SCL_SET;
+        }
+        dst = timPutStop(dst);
+        tim.mode = i2cCmd;                                  // Then configure the display again
+        tim.ptr = tim.config;
+        tim.count = sizeof(tim.config);
+        tim.state = tx_restart;
+        break;
+      case tx_restart:
+        dst = timPutStart(dst);
+        tim.state = tx_addr;
+        break;
+      case tx_start:
+        if(!timNextTransaction()){
+          tim.done = 1;
+          tim.lastHalf = half;
+          break;
+        }
+        dst = timPutStart(dst);
+        tim.state = tx_addr;
+        break;
+      case tx_addr:
+        dst = timPutByte(dst, OLED_ADDRESS);
+        tim.state = tx_mode;
+        break;
+      case tx_mode:
+        dst = timPutByte(dst, tim.mode);
+        tim.state = tx_data;
+        break;
+      case tx_data:
+        if(tim.count){
+          dst = timPutByte(dst, *tim.ptr++);
+          tim.count--;
+        }
+        else{
+          dst = timPutStop(dst);
+          tim.state = tx_start;
+        }
+        break;
+    }
+  }
+  while(dst<end){
+    *dst++ = 0;
+  }
+}
+
+static void timStop(void){
+  TIM2->CR1 &= ~TIM_CR1_CEN;
+  HAL_DMA_Abort(&tim.dma);
+  oled.row=0;
+  oled.status=oled_idle;
+}
+
+// The DMA must be sending the other half while this one is refilled. The counter has the words left to the end of the buffer.
+static bool timSendingHalf(uint8_t half){
+  uint16_t left = __HAL_DMA_GET_COUNTER(&tim.dma);
+
+  return half ? (left<=TIM_DMA_HALF) : (left>TIM_DMA_HALF);
+}
+
+// The interrupt came too late and the DMA sent old symbols, the display got garbage (Data or any command).
+// Abort the frame, the next update clears the bus, configures the display and sends everything again.
+static void timUnderrun(void){
+  oled.underruns++;
+  tim.recover = 1;
+  invalidate_display();
+  timStop();
+}
+
+// Half sent: refill it, or stop after the end of the frame
+static void timRefill(uint8_t half){
+  if(timSendingHalf(half)){
+    timUnderrun();
+  }
+  else if(tim.done && tim.lastHalf==half){
+    timStop();
+  }
+  else{
+    timFill(half);
+    if(timSendingHalf(half)){                               // Reached while filling, part of it was sent before being written
+      timUnderrun();
+    }
+  }
+}
+
+static void timHalfCallback(DMA_HandleTypeDef *dma){
+  timRefill(0);
+}
+
+static void timCpltCallback(DMA_HandleTypeDef *dma){
+  timRefill(1);
+}
+
+// Start sending the dirty pages in background
+static void timStart(void){
+  tim.state = tx_start;
+  if(tim.recover){
+    uint8_t *cmd = tim.config;
+
+    memset(cmd, 0xE3, TIM_RECOVER_NOPS);                    // Parameters of a command cut by the abort, otherwise NOPs
+    cmd += TIM_RECOVER_NOPS;
+    *cmd++ = 0x2E;                                          // Deactivate scroll
+    memcpy(cmd, oledConfig, sizeof(oledConfig));
+    cmd += sizeof(oledConfig);
+    *cmd++ = 0x81;                                          // Set Contrast Control
+    *cmd++ = lastContrast;
+    *cmd++ = 0xAF;                                          // Set Display On
+    tim.state = tx_recover;
+    tim.recover = 0;
+  }
+  tim.data = NULL;
+  tim.done = 0;
+  timFill(0);
+  timFill(1);
+  if(HAL_DMA_Start_IT(&tim.dma, (uint32_t)tim.stream, (uint32_t)&SW_SCL_GPIO_Port->BSRR, 2*TIM_DMA_HALF)!=HAL_OK){
+    Error_Handler();
+  }
+  TIM2->CNT = 0;
+  TIM2->CR1 |= TIM_CR1_CEN;
+}
+
+// SCL and SDA must be in the same port, the DMA writes to the SCL port
+static void timInit(void){
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  __HAL_RCC_TIM2_CLK_ENABLE();
+
+  tim.dma.Instance = DMA1_Channel7;
+  tim.dma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  tim.dma.Init.PeriphInc = DMA_PINC_DISABLE;
+  tim.dma.Init.MemInc = DMA_MINC_ENABLE;
+  tim.dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+  tim.dma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+  tim.dma.Init.Mode = DMA_CIRCULAR;
+  tim.dma.Init.Priority = DMA_PRIORITY_LOW;
+  if(HAL_DMA_Init(&tim.dma)!=HAL_OK){
+    Error_Handler();
+  }
+  tim.dma.XferHalfCpltCallback = timHalfCallback;
+  tim.dma.XferCpltCallback = timCpltCallback;
+  HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 3, 0);           // Lowest priority, below the ADC and the iron timers
+  HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+
+  TIM2->PSC = 0;                                            // Timer clock = HCLK (APB1 prescaler 1, or x2 multiplier)
+  TIM2->ARR = ((SystemCoreClock/1000000)*I2C_HIGH_NS)/1000; // One word per period
+  TIM2->CCR2 = 0;                                           // Compare 2 match on every period
+  TIM2->DIER = TIM_DIER_CC2DE;                              // Request a DMA transfer on each match
+  TIM2->EGR = TIM_EGR_UG;
+  oled.use_tim=1;
+}
+
+void DMA1_Channel7_IRQHandler(void){
+  HAL_DMA_IRQHandler(&tim.dma);
+}
+
+// Stop the background transfer. The error handlers continue in blocking mode
+void display_abort(void){
+  timStop();
+  oled.use_tim=0;
+  invalidate_display();
+}
+#endif
+
 void update_display( void ){
+    if(!oled.started){                                    // Display not started yet, start it now. The buffer is sent when starting
+      ssd1306_start();
+      return;
+    }
     if(oled.status!=oled_idle) { return; }                // If OLED busy, skip update
     if(oled.row!=0){ Error_Handler(); }
 
+    dma_mem_wait();                                       // Buffer fill might be still running
+    findDirtyPages();
+#ifdef OLED_HORIZONTAL
+    mergeDirtyPages();
+#endif
+    if(!oled.dirty){                                      // Nothing changed
+      return;
+    }
+    oled.frames++;
+
 #if (defined OLED_I2C || defined OLED_SPI) && (!defined OLED_DEVICE || (defined OLED_DEVICE && defined I2C_TRY_HW))
     if(oled.use_sw){
-      for(uint8_t row=0;row<8;row++){
+#ifdef OLED_TIM_DMA
+      if(oled.use_tim){                                   // Send in background
+        oled.status=oled_busy;
+        timStart();
+        return;
+      }
+#endif
+      uint32_t start = HAL_GetTick();
+      uint8_t pages;
+      for(uint8_t row=0;row<8;row+=pages){
+        uint8_t column;
+        uint16_t count;
+
+        pages=1;
+        if(!(oled.dirty & (1<<row))){
+          continue;
+        }
+        count=nextTransfer(row, &pages, &column);
         HAL_IWDG_Refresh(&hiwdg);
-        setOledRow(row);
+        setOledWindow(row, pages, column, count);
 
         #if defined OLED_SPI
 
@@ -373,18 +836,28 @@ void update_display( void ){
         Oled_Set_DC();
         #endif
 
-        spi_send((uint8_t *)&oled.buffer[128*row],128);
+        spi_send((uint8_t *)&oled.buffer[(128*row)+column],count);
 
         #ifdef USE_CS
         Oled_Set_CS();
         #endif
 
         #elif defined OLED_I2C
-        i2cSend((uint8_t *)&oled.buffer[128*row],128,i2cData);
+        i2cSend((uint8_t *)&oled.buffer[(128*row)+column],count,i2cData);
         #endif
       }
+      oled.swTime += HAL_GetTick()-start;
       return;
     }
+#endif
+#ifdef OLED_DOUBLE_BUFFER
+    {                                                     // Copy the changed pages, the DMA sends the copy while the next frame is drawn
+      uint8_t first=0, last=7;
+      while(!(oled.dirty & (1<<first))){ first++; }
+      while(!(oled.dirty & (1<<last))){ last--; }         // The unchanged pages in between are already the same in both buffers
+      dma_memcpy32(&oled.front[128*first], &oled.buffer[128*first], (uint16_t)128*(last-first+1));
+      dma_mem_wait();
+    }
 #endif
     oled.status=oled_busy;
 #if defined OLED_SPI && defined OLED_DEVICE
@@ -396,16 +869,21 @@ void update_display( void ){
 }
 
 #if !defined OLED_DEVICE || (defined OLED_DEVICE && defined I2C_TRY_HW)
-void setOledRow(uint8_t row){
-  write_cmd(0xB0|row);                                    // Set the OLED Row address
-  write_cmd(systemSettings.settings.OledOffset);
-  write_cmd(0x10);
+void setOledWindow(uint8_t row, uint8_t pages, uint8_t column, uint16_t count){
+  uint8_t cmd[OledWindowCmd];
+
+  getWindowCmd(row, pages, column, count, cmd);
+  for(uint8_t x=0;x<OledWindowCmd;x++){
+    write_cmd(cmd[x]);
+  }
 }
 #endif
 
 void setContrast(uint8_t value) {
-  write_cmd(0x81);                                        // Set Contrast Control
-  write_cmd(value);                                       // Default => 0xFF
+  if(oled.started){                                       // Otherwise it's set when starting the display
+    write_cmd(0x81);                                      // Set Contrast Control
+    write_cmd(value);                                     // Default => 0xFF
+  }
   lastContrast = value;
 }
 
@@ -428,11 +906,14 @@ void ssd1306_init(I2C_HandleTypeDef *device,DMA_HandleTypeDef *dma){
 #elif defined OLED_I2C && !defined OLED_DEVICE && !defined I2C_TRY_HW
 void ssd1306_init(DMA_HandleTypeDef *dma){
   enable_soft_Oled();
+  #ifdef OLED_TIM_DMA
+  timInit();
+  #endif
 #else
   #error "Wrong display configuration in board.h!"
 #endif
 
-  oled.fillDMA= dma;
+  dma_mem_init(dma);
 
 #if defined OLED_SPI
   #ifndef USE_DC
@@ -467,9 +948,20 @@ void ssd1306_init(DMA_HandleTypeDef *dma){
   #endif
 
 #endif
-  systemSettings.settings.OledOffset = 2;         // Set by default while system settings are not loaded
-  HAL_IWDG_Refresh(&hiwdg);                       // Clear watchdog
-  HAL_Delay(100);                                 // 100mS wait for internal initialization
+  systemSettings.settings.OledOffset = 2;         // Set by default while system settings are not loaded, not a change to be saved
+  lastContrast = 0xFF;                            // Init in max contrast
+}
+
+// Configure the display and turn it on. Called after starting the iron, so the display doesn't delay the heating at boot.
+// Also called by update_display() if something must be shown before (Boot errors).
+void ssd1306_start(void){
+  if(oled.started){
+    return;
+  }
+  oled.started=1;
+  while(HAL_GetTick()<OLED_STARTUP_TIME){         // Wait for internal initialization. The boot usually takes longer
+    HAL_IWDG_Refresh(&hiwdg);                     // Clear watchdog
+  }
 #if defined OLED_I2C && defined OLED_DEVICE && defined I2C_TRY_HW
   oled.use_sw=1;
   //disable_soft_Oled();
@@ -494,35 +986,14 @@ void ssd1306_init(DMA_HandleTypeDef *dma){
     oled.use_sw=1;
 #endif
   write_cmd(0xAE);          // Display Off
-  write_cmd(0xD5);          // Set Display Clock Divide Ratio / Oscillator Frequency
-  write_cmd(0xF0);          // Set max framerate
-  write_cmd(0xA8);          // Set Multiplex Ratio
-  write_cmd(0x3F);          // Default => 0x3F (1/64 Duty)
-  write_cmd(0xD3);          // Set Display Offset
-  write_cmd(0x00);          // Default => 0x00
-  write_cmd(0x40|0x00);     // Set Display Start Line
-  write_cmd(0x20);          // Set Memory Addressing Mode
-  write_cmd(0x02);          // Default => 0x02
-  write_cmd(0xA0|0x01);     // Set Segment Re-Map
-  write_cmd(0xC0|0x08);     // Set COM Output Scan Direction
-  write_cmd(0xDA);          // Set COM Pins Hardware Configuration
-  write_cmd(0x02|0x10);     // Default => 0x12 (0x10)
-  setContrast(0xFF);        // Init in max contrast
-  write_cmd(0xD9);          // Set Pre-Charge Period
-  write_cmd(0x22);          // Default => 0x22 (2 Display Clocks [Phase 2] / 2 Display Clocks [Phase 1])
-
-  write_cmd(0xDB);          // Set VCOMH Deselect Level
-  write_cmd(0x30);          // Default => 0x20 (0.77*VCC)
-
-  write_cmd(0xA4|0x00);     // Set Entire Display On/Off
-  write_cmd(0xA6|0x00);     // Set Inverse Display On/Off
-  write_cmd(0x8D);          // Set Charge Pump command
-  write_cmd(0x14);          // Enable charge pump
-  write_cmd(0x33);          // Charge pump to 9V
-  FillBuffer(BLACK,fill_dma);     // Clear buffer
-  update_display();         // Update display CGRAM
-
-  while(oled.status!=oled_idle);  // Wait for DMA completion (If enabled)
+  for(uint8_t x=0;x<sizeof(oledConfig);x++){
+    write_cmd(oledConfig[x]);
+  }
+  setContrast(lastContrast);// Max contrast, or the value set before starting
+  invalidate_display();     // Display RAM content is unknown, send all the pages
+  update_display();         // Update display CGRAM (Buffer is clear, or showing a boot error)
+
+  oledWait(oled.status!=oled_idle);  // Wait for DMA completion (If enabled)
 
   write_cmd(0xAF);          // Set Display On
 }
@@ -530,6 +1001,7 @@ void ssd1306_init(DMA_HandleTypeDef *dma){
 /*
 *  Clear buffer with 32bit-transfer for fast filling (ensure that Oled buffer is 32-bit aligned!)
 *   128 * 8 = 1KB, / 4byte DMA txfer = 256 clock cycles (in theory)
+*   The DMA fill runs in background, drawing waits for it in ssd1306_hvline()
 *   Args:
 *       color:   0 = black, 1 = white
 *       mode:   0 = Use software(fail-safe), 1= Use DMA (normal operation)
@@ -537,23 +1009,29 @@ void ssd1306_init(DMA_HandleTypeDef *dma){
 
 void FillBuffer(bool color, bool mode){
   uint32_t fillVal;
-  while(oled.status!=oled_idle);              // Don't write to buffer while screen buffer is being transfered
+  oledWait(oledBufferBusy());                 // Don't write to buffer while screen buffer is being transfered
 
   if(color==WHITE){ fillVal=0xffffffff; }     // Fill color = white
   else{ fillVal=0; }                          // Fill color = black
 
   if(mode==fill_dma){                         // use DMA
-     HAL_DMA_Start(oled.fillDMA,(uint32_t)&fillVal,(uint32_t)oled.ptr,sizeof(oled.buffer)/sizeof(uint32_t));
-     HAL_DMA_PollForTransfer(oled.fillDMA, HAL_DMA_FULL_TRANSFER, 3000);
+    dma_memset32(oled.buffer, fillVal, sizeof(oled.buffer));
   }
   else{                                       // use software
-    uint32_t* bf=(uint32_t*)oled.ptr;         // Pointer to oled buffer using 32bit data for faster operation
+    dma_mem_wait();                           // Don't mix with a DMA fill still running
+    uint32_t* bf=(uint32_t*)oled.buffer;      // Pointer to oled buffer using 32bit data for faster operation
     for(uint16_t x=0;x<sizeof(oled.buffer)/sizeof(uint32_t);x++){  // Write to oled buffer
       bf[x]=fillVal;
     }
   }
 }
 
+// u8g2 drawing function, waits for the DMA fill before writing to the buffer
+void ssd1306_hvline(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir){
+  dma_mem_wait();
+  fastHVLine(u8g2, x, y, len, dir);
+}
+
 #if (defined OLED_I2C || defined OLED_SPI) && defined OLED_DEVICE
 
 // Abort DMA transfers and reset status
@@ -568,19 +1046,25 @@ void display_abort(void){
     __HAL_UNLOCK(oled.device);
     HAL_DMA_PollForTransfer(oled.device->hdmatx, HAL_DMA_FULL_TRANSFER, 100);  // Wait for DMA to finish
   }
+  invalidate_display();                                                       // Transfer interrupted, send everything in the next update
   oled.status=oled_idle;                                                      // Force oled idle status
 }
 
 
 // Screen update for hard error handlers (crashes) not using DMA
 void update_display_ErrorHandler(void){
-  for(uint8_t row=0;row<8;row++){
+  dma_mem_wait();
+#ifdef OLED_HORIZONTAL
+  const uint8_t pages = systemSettings.settings.OledOffset ? 1 : 8;           // Whole frame at once, or page by page with a column offset
+  const uint8_t width = OledColumns;
+#else
+  const uint8_t pages=1;
+  const uint8_t width=128;
+#endif
+  for(uint8_t row=0;row<8;row+=pages){
 
-    uint8_t cmd[3]={
-      0xB0|row,
-      systemSettings.settings.OledOffset,
-      0x10
-    };
+    uint8_t cmd[OledWindowCmd];
+    getWindowCmd(row, pages, 0, (uint16_t)width*pages, cmd);
 
     #ifdef OLED_SPI
 
@@ -592,7 +1076,7 @@ void update_display_ErrorHandler(void){
     Oled_Clear_DC();
     #endif
 
-    if(HAL_SPI_Transmit(oled.device, cmd, 3, 50)){
+    if(HAL_SPI_Transmit(oled.device, cmd, OledWindowCmd, 50)){
       while(1){                                                               // If error happens at this stage, just do nothing
         HAL_IWDG_Refresh(&hiwdg);
       }
@@ -601,19 +1085,19 @@ void update_display_ErrorHandler(void){
     Oled_Set_DC();
     #endif
 
-    if(HAL_SPI_Transmit(oled.device, (uint8_t*)oled.ptr + (row * 128), 128, 1000)!=HAL_OK){
+    if(HAL_SPI_Transmit(oled.device, oled.buffer + (row * 128), (uint16_t)width*pages, 1000)!=HAL_OK){
       while(1){                                                               // If error happens at this stage, just do nothing
         HAL_IWDG_Refresh(&hiwdg);
       }
     }
 
     #elif defined OLED_I2C
-    if(HAL_I2C_Mem_Write(oled.device, OLED_ADDRESS, 0x00, 1, cmd, 3, 50)){
+    if(HAL_I2C_Mem_Write(oled.device, OLED_ADDRESS, 0x00, 1, cmd, OledWindowCmd, 50)){
       while(1){                                                               // If error happens at this stage, just do nothing
         HAL_IWDG_Refresh(&hiwdg);
       }
     }
-    if(HAL_I2C_Mem_Write(oled.device, OLED_ADDRESS, 0x40, 1, (uint8_t*)oled.ptr + (row * 128), 128, 1000)!=HAL_OK){
+    if(HAL_I2C_Mem_Write(oled.device, OLED_ADDRESS, 0x40, 1, oled.buffer + (row * 128), (uint16_t)width*pages, 1000)!=HAL_OK){
       while(1){                                                               // If error happens at this stage, just do nothing
         HAL_IWDG_Refresh(&hiwdg);
       }
@@ -635,6 +1119,9 @@ void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *device){
 
   if(device == oled.device){
     HAL_DMA_PollForTransfer(oled.device->hdmatx, HAL_DMA_FULL_TRANSFER, 10);  //Wait for DMA to finish
+    while(oled.row<8 && !(oled.dirty & (1<<oled.row))){  // Skip unchanged pages
+      oled.row++;
+    }
     if(oled.row>7){
 
       #if defined OLED_SPI && defined USE_CS
@@ -646,11 +1133,9 @@ void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *device){
       return;                                           // Return without retriggering DMA.
     }
 
-    uint8_t cmd[3]={
-      0xB0|oled.row,
-      systemSettings.settings.OledOffset,
-      0x10
-    };
+    uint8_t column, pages, cmd[OledWindowCmd];
+    uint16_t count = nextTransfer(oled.row, &pages, &column);
+    getWindowCmd(oled.row, pages, column, count, cmd);
 
 #ifdef OLED_SPI
 
@@ -664,7 +1149,7 @@ void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *device){
     #endif
     uint8_t try =3;
     while(try){
-      if(HAL_SPI_Transmit(oled.device, cmd, 3, 50)==HAL_OK){      // Send row command in blocking mode
+      if(HAL_SPI_Transmit(oled.device, cmd, OledWindowCmd, 50)==HAL_OK){      // Send window command in blocking mode
         break;
       }
       else{
@@ -681,14 +1166,14 @@ void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *device){
     Oled_Set_DC();
     #endif
 
-    if(HAL_SPI_Transmit_DMA(oled.device,(uint8_t *) oled.ptr+((uint16_t)128*oled.row), 128)!= HAL_OK){      // Send row data in DMA interrupt mode
+    if(HAL_SPI_Transmit_DMA(oled.device,(uint8_t *) oled.ptr+((uint16_t)128*oled.row)+column, count)!= HAL_OK){      // Send row data in DMA interrupt mode
       Error_Handler();
     }
 
 #elif defined OLED_I2C
     uint8_t try =3;
 		while(try){
-      if(HAL_I2C_Mem_Write(oled.device, OLED_ADDRESS, 0x00, 1, cmd, 3, 50)==HAL_OK){
+      if(HAL_I2C_Mem_Write(oled.device, OLED_ADDRESS, 0x00, 1, cmd, OledWindowCmd, 50)==HAL_OK){
       	break;
 	    }
       else{
@@ -697,12 +1182,12 @@ void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *device){
         try--;
       }
     }    
-    if(HAL_I2C_Mem_Write_DMA(oled.device, OLED_ADDRESS, 0x40, 1, oled.ptr+(128*oled.row), 128)!=HAL_OK){
+    if(HAL_I2C_Mem_Write_DMA(oled.device, OLED_ADDRESS, 0x40, 1, oled.ptr+(128*oled.row)+column, count)!=HAL_OK){
       Error_Handler();
     }
 #endif
 
-    oled.row++;
+    oled.row += pages;
   }
 }
 
@@ -714,6 +1199,8 @@ void FatalError(uint8_t type){
   if(!oled.use_sw){
     display_abort();
   }
+  #elif defined OLED_TIM_DMA
+  display_abort();
   #endif
 
   setSafeMode(enable);
@@ -785,7 +1272,7 @@ void putStrAligned(char* str, uint8_t y, AlignType align){
     u8g2_DrawStr(&u8g2, 0, y, str);
   }
   else{
-    uint8_t len = u8g2_GetStrWidth(&u8g2, str);
+    uint8_t len = cachedStrWidth(&u8g2, str);
     if(align==align_center){
       u8g2_DrawStr(&u8g2, ((OledWidth-1)-len)/2, y, str);
     }
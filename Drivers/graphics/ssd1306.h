@@ -33,29 +33,69 @@ typedef enum{
 	error_RUNAWAY_UNKNOWN,
 }FatalErrors;
 
+#if defined OLED_DOUBLE_BUFFER && (defined STM32F101xB || !defined OLED_DEVICE)
+#undef OLED_DOUBLE_BUFFER				// Not enough RAM, or no DMA transfers to overlap with
+#endif
+
+#if defined OLED_TIM_DMA && (defined OLED_DEVICE || !defined OLED_I2C || !(defined STM32F101xB || defined STM32F103xB))
+#error "OLED_TIM_DMA is only supported for software I2C displays in STM32F1"
+#endif
+
+#if defined OLED_PROFILE && !defined SWO_PRINT
+#error "OLED_PROFILE needs SWO_PRINT"
+#endif
+
+#define OLED_STARTUP_TIME	100			// Time from power up until the display can be configured (mS)
+
 #define OledWidth	128
 #define OledHeight	64
+#define OledSegment	16				// Columns per checksum segment, changes are tracked with this resolution
+#define OledSegments	(OledWidth/OledSegment)
 
 // buffer needs to be aligned to 32bit(4byte) boundary, as FillBuffer() uses 32bit transfer for increased speed
 typedef struct{
 	__attribute__((aligned(4))) uint8_t buffer[128*8]; // 128x64 1BPP OLED
+	#ifdef OLED_DOUBLE_BUFFER
+	__attribute__((aligned(4))) uint8_t front[128*8];	// Copy being sent by the DMA, the GUI keeps drawing into buffer meanwhile
+	#endif
 	uint8_t *ptr;
 	volatile uint8_t status;
 	volatile uint8_t row;
 	volatile uint8_t use_sw;
+	#ifdef OLED_TIM_DMA
+	volatile uint8_t use_tim;					// Software display sent in background by the timer DMA
+	#endif
+	uint8_t started;
+	volatile uint8_t dirty;						// Pages pending to be sent, one bit per page
+	uint8_t segments[8];						// Segments pending to be sent in each page, one bit per segment
+	uint8_t offset;								// Column offset used in the last update
+	uint32_t segmentCRC[8][OledSegments];		// Checksum of each segment when it was last sent
+	uint32_t frames;							// Updates sending any page
+	uint32_t bytes;								// Sent bytes, including the position commands
+	uint32_t swTime;							// Time spent sending in software mode (mS), the CPU is blocked
+	#ifdef OLED_TIM_DMA
+	uint32_t underruns;							// Background frames aborted, the DMA interrupt came too late
+	#endif
 	#if defined OLED_SPI && defined OLED_DEVICE
 	SPI_HandleTypeDef *device;
 
 	#elif defined OLED_I2C && defined OLED_DEVICE
 	I2C_HandleTypeDef *device;
 	#endif
-
-	DMA_HandleTypeDef *fillDMA;
 }oled_t;
 extern oled_t oled;
 
 enum { fill_soft, fill_dma };
 
+#ifdef OLED_DOUBLE_BUFFER
+#define oledBufferBusy()	(0)							// The DMA never reads the drawing buffer
+#else
+#define oledBufferBusy()	(oled.status!=oled_idle)	// Don't draw while the buffer is being sent
+#endif
+#ifndef oledWait									// Host builds provide their own, running the emulated transfer
+#define oledWait(busy)		while(busy)					// Busy wait for the display transfer
+#endif
+
 #define Oled_Set_SCL() 		SW_SCL_GPIO_Port->BSRR = (uint32_t)SW_SCL_Pin
 #define Oled_Clear_SCL() 	SW_SCL_GPIO_Port->BRR = (uint32_t)SW_SCL_Pin
 
@@ -111,7 +151,25 @@ void i2cStart(void);
 void i2cStop(void);
 void i2cBegin(uint8_t mode);
 void i2cSend(uint8_t* bf, uint16_t count, uint8_t mode);
-void i2cDelay(void);
+
+// SW I2C timing, delays are calibrated for the core clock. Can be set in board.h if the core runs slower than the max
+#ifndef SW_I2C_CORE_MHZ
+#if defined STM32F101xB
+#define SW_I2C_CORE_MHZ		36
+#elif defined STM32F072xB
+#define SW_I2C_CORE_MHZ		48
+#else
+#define SW_I2C_CORE_MHZ		72
+#endif
+#endif
+#define I2C_HIGH_NS			550						// SCL high time
+#define I2C_SETUP_NS		150						// SDA setup before the SCL rising edge, SDA rises slowly through the pullup
+#ifndef cycleDelay									// Host builds provide their own
+#define cycleDelay(ns)		do{ uint32_t n=((SW_I2C_CORE_MHZ*(ns))+2999)/3000;		/* 3 cycles per loop, rounded up */	\
+							__asm volatile("1: subs %0, #1\n\tbne 1b" : "+r"(n) : : "cc"); }while(0)
+#endif
+#define i2cDelay()			cycleDelay(I2C_HIGH_NS)
+#define i2cSetupDelay()		cycleDelay(I2C_SETUP_NS)
 #endif
 
 #if defined OLED_DEVICE
@@ -127,13 +185,15 @@ void FatalError(uint8_t type);
 void write_data(uint8_t* data, uint16_t count);
 void write_cmd(uint8_t cmd);
 void pset(uint8_t x, uint8_t y, bool c);
+void ssd1306_start(void);
 void update_display(void);
 void display_abort(void);
 void update_display_ErrorHandler(void);
 void setContrast(uint8_t value);
-void setOledRow(uint8_t row);
+void setOledWindow(uint8_t row, uint8_t pages, uint8_t column, uint16_t count);
 uint8_t getContrast();
 void FillBuffer(bool color, bool mode);
+void ssd1306_hvline(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
 void putStrAligned(char* str, uint8_t y, AlignType align);
 void Reset_onError(void);
 #endif /* GRAPHICS_SSD1306_H_ */
@@ -0,0 +1,99 @@
+/*
+ * bitmap_test.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host test for drawBitmap (Drivers/graphics/bitmap.c) against u8g2_DrawXBMP, with the converted bitmaps (gui/bitmaps.c)
+ *  and their source XBM files. Both must give the same buffer at all positions, colors, bitmap modes and clip windows.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "u8g2.h"
+#include "bitmaps.h"
+#include "../xbm2page/assets/splash.xbm"
+#include "../xbm2page/assets/shake.xbm"
+#include "../xbm2page/assets/temp.xbm"
+#include "../xbm2page/assets/volt.xbm"
+#include "../xbm2page/assets/warning.xbm"
+
+static uint8_t bufU8g2[1024] __attribute__((aligned(4)));
+static uint8_t bufBitmap[1024] __attribute__((aligned(4)));
+static u8g2_t u8g2Ref, u8g2Bitmap;
+
+void dma_mem_wait(void){}                                           // No DMA fill in the host
+
+typedef struct{
+  const char          *name;
+  const uint8_t       *bmp;
+  uint8_t             width, height;
+  const unsigned char *xbm;
+}image_t;
+
+static const image_t images[] = {
+    { "splash",  splashBMP,  splash_width,  splash_height,  splash_bits },
+    { "shake",   shakeBMP,   shake_width,   shake_height,   shake_bits },
+    { "temp",    tempBMP,    temp_width,    temp_height,    temp_bits },
+    { "volt",    voltBMP,    volt_width,    volt_height,    volt_bits },
+    { "warning", warningBMP, warning_width, warning_height, warning_bits },
+};
+
+// Clip windows: x0, y0, x1, y1. Full screen, inside a page, across pages, empty
+static const u8g2_uint_t clips[][4] = {
+    { 0, 0, 128, 64 },
+    { 10, 17, 60, 23 },
+    { 3, 5, 100, 45 },
+    { 20, 20, 20, 40 },
+};
+
+static void setup(u8g2_t *u8g2, uint8_t *buf){
+  u8g2_SetupDisplay(u8g2, u8x8_d_ssd1306_128x64_noname, u8x8_cad_001, u8x8_dummy_cb, u8x8_dummy_cb);
+  u8g2_SetupBuffer(u8g2, buf, 8, u8g2_ll_hvline_vertical_top_lsb, U8G2_R0);
+  u8g2_InitDisplay(u8g2);
+}
+
+int main(void){
+  int errors=0, cases=0;
+
+  setup(&u8g2Ref, bufU8g2);
+  setup(&u8g2Bitmap, bufBitmap);
+
+  for(uint8_t i=0; i<sizeof(images)/sizeof(image_t); i++){
+    const image_t *img = &images[i];
+    if(img->bmp[0]!=img->width || img->bmp[1]!=img->height){
+      printf("FAIL: %s: size %ux%u, the XBM is %ux%u. Run make bitmaps in xbm2page\n", img->name, img->bmp[0], img->bmp[1], img->width, img->height);
+      return 1;
+    }
+    for(uint8_t clip=0; clip<sizeof(clips)/sizeof(clips[0]); clip++){
+      u8g2_SetClipWindow(&u8g2Ref, clips[clip][0], clips[clip][1], clips[clip][2], clips[clip][3]);
+      u8g2_SetClipWindow(&u8g2Bitmap, clips[clip][0], clips[clip][1], clips[clip][2], clips[clip][3]);
+      for(uint8_t mode=0; mode<2; mode++){
+        u8g2_SetBitmapMode(&u8g2Ref, mode);
+        u8g2_SetBitmapMode(&u8g2Bitmap, mode);
+        for(uint8_t color=0; color<3; color++){
+          u8g2_SetDrawColor(&u8g2Ref, color);
+          u8g2_SetDrawColor(&u8g2Bitmap, color);
+          for(int y=-img->height; y<70; y++){
+            for(int x=-img->width; x<130; x+=3){
+              memset(bufU8g2, color ? 0x5A : 0xFF, sizeof(bufU8g2));
+              memcpy(bufBitmap, bufU8g2, sizeof(bufBitmap));
+              u8g2_DrawXBMP(&u8g2Ref, x, y, img->width, img->height, img->xbm);
+              drawBitmap(&u8g2Bitmap, x, y, img->bmp);
+              cases++;
+              if(memcmp(bufU8g2, bufBitmap, sizeof(bufU8g2)) && errors++<10){
+                printf("Mismatch: %s, clip %u, mode %u, color %u, x %d, y %d\n", img->name, clip, mode, color, x, y);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  printf("%d/%d cases match\n", cases-errors, cases);
+  if(errors){
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
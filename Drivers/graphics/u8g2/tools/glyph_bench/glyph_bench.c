@@ -0,0 +1,103 @@
+/*
+ * glyph_bench.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host benchmark for the glyph cache (Drivers/graphics/glyph_cache.c) against u8g2_DrawStr, big temperature font.
+ *  First checks both give the same buffer and width for strings at all colors and positions, including partially
+ *  outside the screen, with a clip window (Drawn by u8g2) and after the cache is full (Glyphs removed and decoded again).
+ *  Then times them.
+ */
+
+#include <time.h>
+#include "u8g2.h"
+#include "glyph_cache.h"
+#include "../font/bdfconv/c/ironTemp.c"
+
+#define RUNS    200000
+
+static uint8_t bufU8g2[1024] __attribute__((aligned(4)));
+static uint8_t bufCache[1024] __attribute__((aligned(4)));
+static u8g2_t u8g2Ref, u8g2Cache;
+
+void dma_mem_wait(void){}                                           // No DMA fill in the host
+
+static void setup(u8g2_t *u8g2, uint8_t *buf){
+  u8g2_SetupDisplay(u8g2, u8x8_d_ssd1306_128x64_noname, u8x8_cad_001, u8x8_dummy_cb, u8x8_dummy_cb);
+  u8g2_SetupBuffer(u8g2, buf, 8, u8g2_ll_hvline_vertical_top_lsb, U8G2_R0);
+  u8g2_InitDisplay(u8g2);
+  u8g2_SetFontMode(u8g2, 1);                                        // Same settings as guiInit()
+  u8g2_SetFontDirection(u8g2, 0);
+  u8g2_SetFontPosTop(u8g2);
+  u8g2_SetFont(u8g2, u8g2_font_ironTemp);
+}
+
+static double now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + (t.tv_nsec*1e-9);
+}
+
+static const char *strings[] = { "350", "0123456789", "-12", "999", " 42", "\260C", "100\260F" };
+
+static int check(void){
+  int errors=0, cases=0;
+  for(uint8_t clip=0; clip<2; clip++){
+    if(clip){
+      u8g2_SetClipWindow(&u8g2Ref, 10, 20, 100, 50);
+      u8g2_SetClipWindow(&u8g2Cache, 10, 20, 100, 50);
+    }
+    for(uint8_t color=0; color<3; color++){
+      u8g2_SetDrawColor(&u8g2Ref, color);
+      u8g2_SetDrawColor(&u8g2Cache, color);
+      for(uint8_t s=0; s<sizeof(strings)/sizeof(strings[0]); s++){
+        for(int y=-20; y<64; y+=3){
+          for(int x=-20; x<128; x+=7){
+            memset(bufU8g2, color ? 0x5A : 0xFF, sizeof(bufU8g2));
+            memcpy(bufCache, bufU8g2, sizeof(bufCache));
+            u8g2_uint_t wRef = u8g2_DrawStr(&u8g2Ref, x, y, strings[s]);
+            u8g2_uint_t wCache = glyphCacheDrawStr(&u8g2Cache, x, y, strings[s]);
+            cases++;
+            if((wRef!=wCache || memcmp(bufU8g2, bufCache, sizeof(bufU8g2))) && errors++<10){
+              printf("Mismatch: \"%s\", color %u, x %d, y %d, clip %u, width %u/%u\n", strings[s], color, x, y, clip, wRef, wCache);
+            }
+          }
+        }
+      }
+    }
+  }
+  u8g2_SetMaxClipWindow(&u8g2Ref);
+  u8g2_SetMaxClipWindow(&u8g2Cache);
+  printf("%d/%d cases match\n\n", cases-errors, cases);
+  return errors;
+}
+
+int main(void){
+  static const char temps[3][8] = { "349\260C", "350\260C", "351\260C" };
+  double time[2];
+
+  setup(&u8g2Ref, bufU8g2);
+  setup(&u8g2Cache, bufCache);
+
+  if(check()){
+    return 1;
+  }
+  for(uint8_t i=0; i<2; i++){
+    u8g2_t *u8g2 = i ? &u8g2Cache : &u8g2Ref;
+    u8g2_SetDrawColor(u8g2, 1);
+    double start = now();
+    for(uint32_t n=0; n<RUNS; n++){
+      if(i){
+        glyphCacheDrawStr(u8g2, 40, 17, temps[n%3]);
+      }
+      else{
+        u8g2_DrawStr(u8g2, 40, 17, temps[n%3]);
+      }
+    }
+    time[i] = (now()-start)*1e9/RUNS;
+  }
+  printf("%-16s %12s %12s %8s\n", "Test", "u8g2 ns", "cached ns", "Speedup");
+  printf("%-16s %12.1f %12.1f %7.1fx\n", "temperature", time[0], time[1], time[0]/time[1]);
+  return 0;
+}
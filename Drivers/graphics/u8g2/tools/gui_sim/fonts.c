@@ -0,0 +1,14 @@
+/*
+ * fonts.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Project fonts for the host builds. The data is generated by bdfconv (../font), u8g2.h must come first for U8G2_FONT_SECTION.
+ */
+
+#include "u8g2.h"
+#include "../font/bdfconv/c/menu.c"
+#include "../font/bdfconv/c/labels.c"
+#include "../font/bdfconv/c/noIron_Sleep.c"
+#include "../font/bdfconv/c/ironTemp.c"
@@ -0,0 +1,104 @@
+/*
+ * gui_bench.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host benchmark of the screen rendering, in fixed states: idle, heating with the graph, error list, settings menu scrolled.
+ *
+ *  Each state runs SIM_BENCH_TIME of emulated time, and prints per rendered frame:
+ *  - The host time of the main loop passes rendering it (Input, screen update, draw and starting the transfer).
+ *  - The u8g2 line calls and their pixels (Bitmaps and cached glyphs are copied directly, not counted).
+ *  - The I2C bytes sent to the display.
+ *  The host time is only good to compare changes in the same PC, the line calls and bytes are the same as in the target.
+ */
+
+#include "sim_common.h"
+
+#define SIM_BENCH_TIME    20000                                     // mS of each state
+
+static uint32_t hvlines, pixels;
+
+// ssd1306_hvline() counting the calls
+static void benchHvline(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir){
+  hvlines++;
+  pixels += len;
+  ssd1306_hvline(u8g2, x, y, len, dir);
+}
+
+typedef struct{
+  uint32_t frames, hvlines, pixels, bytes;
+  uint64_t ns;
+}counters_t;
+
+static void getCounters(counters_t *c){
+  c->frames = frameStats.frames;
+  c->hvlines = hvlines;
+  c->pixels = pixels;
+  c->bytes = hostOled.bytes;
+  c->ns = simRenderNs;
+}
+
+static void result(const char *name, counters_t *start){
+  counters_t end;
+  uint32_t frames;
+
+  getCounters(&end);
+  frames = end.frames-start->frames;
+  if(!frames){
+    printf("FAIL: %s: no frames\n", name);
+    exit(1);
+  }
+  printf("%-24s %6u %10.0f %10u %10u %10u\n", name, frames, (double)(end.ns-start->ns)/frames,
+          (end.hvlines-start->hvlines)/frames, (end.pixels-start->pixels)/frames, (end.bytes-start->bytes)/frames);
+}
+
+int main(void){
+  counters_t start;
+
+  simBoot();
+  u8g2.ll_hvline = benchHvline;
+  simRun(1500);
+  simInput(Click);                                                  // First boot, default profile
+  simRun(1000);
+  simTipTemp(180);
+  simRun(500);
+
+  printf("%-24s %6s %10s %10s %10s %10s\n", "State", "Frames", "nS/frame", "hvlines", "Pixels", "I2C bytes");
+
+  getCounters(&start);
+  simRun(SIM_BENCH_TIME);
+  result("idle", &start);
+
+  simInput(Click);
+  getCounters(&start);
+  for(uint32_t t=0; t<SIM_BENCH_TIME; t+=50){
+    simTipTemp(150+((t/50)%60));                                    // Heating from 150 to 210ºC, over and over
+    simRun(50);
+  }
+  result("heating, graph", &start);
+
+  simInput(Click);
+  simSupply(100);
+  simNoIron(1);
+  simRun(500);
+  getCounters(&start);
+  simRun(SIM_BENCH_TIME);
+  result("error list", &start);
+
+  simSupply(240);
+  simNoIron(0);
+  simRun(3000);
+  simInput(LongClick);
+  simInput(Rotate_Increment);
+  simInput(Click);                                                  // System menu, the longest
+  simRun(300);
+  getCounters(&start);
+  for(uint32_t t=0; t<SIM_BENCH_TIME; t+=1200){
+    for(uint8_t x=0; x<12; x++){
+      simInput(x<6 ? Rotate_Increment : Rotate_Decrement);          // 100mS each
+    }
+  }
+  result("settings menu, scrolled", &start);
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * gui_sim.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host test of the screens, against golden images of what the display shows.
+ *
+ *  The GUI goes through a fixed sequence (boot, first boot, main screen states, errors, menus) driven by the encoder
+ *  and the sensor readings, see sim_common.c. After each step the display is captured when the transfer ends.
+ *
+ *  Checks:
+ *  - The display shows the buffer, without bad commands or data sent to a bad window.
+ *  - Each capture matches golden/<step>.pbm. The captures are saved in out/ to look at the differences.
+ *  - The display transfers of each step (Frames and I2C bytes) don't grow over golden/transfers.txt.
+ *
+ *  gui_sim -w writes the goldens after an intended change in the screens, check them before committing.
+ */
+
+#include "sim_common.h"
+#include <string.h>
+#include <sys/stat.h>
+
+#define SIM_GOLDEN        "golden"
+#define SIM_OUT           "out"
+#define SIM_STEPS         20
+
+typedef struct{
+  char      name[32];
+  uint32_t  frames;
+  uint32_t  bytes;
+}transfers_t;
+
+static transfers_t golden[SIM_STEPS], result[SIM_STEPS];
+static uint8_t steps, goldenSteps;
+static uint32_t lastFrames, lastBytes;
+static bool write, failed;
+
+static void loadTransfers(void){
+  FILE *f = fopen(SIM_GOLDEN"/transfers.txt", "r");
+  char line[80];
+
+  if(!f){
+    return;
+  }
+  while(goldenSteps<SIM_STEPS && fgets(line, sizeof(line), f)){
+    transfers_t *t = &golden[goldenSteps];
+
+    if(line[0]!='#' && sscanf(line, "%31s %u %u", t->name, &t->frames, &t->bytes)==3){
+      goldenSteps++;
+    }
+  }
+  fclose(f);
+}
+
+static void saveTransfers(void){
+  FILE *f = fopen(SIM_GOLDEN"/transfers.txt", "w");
+
+  if(!f){
+    perror(SIM_GOLDEN"/transfers.txt");
+    exit(1);
+  }
+  fprintf(f, "# step, frames, I2C bytes\n");
+  for(uint8_t x=0; x<steps; x++){
+    fprintf(f, "%-24s %4u %6u\n", result[x].name, result[x].frames, result[x].bytes);
+  }
+  fclose(f);
+}
+
+// Pixels different between two PBM files, -1 if one can't be read
+static int32_t comparePBM(const char *a, const char *b){
+  FILE *fa = fopen(a, "r"), *fb = fopen(b, "r");
+  int32_t diff = 0;
+  int ca, cb;
+
+  if(!fa || !fb){
+    diff = -1;
+  }
+  else{
+    do{
+      ca = fgetc(fa);
+      cb = fgetc(fb);
+      if(ca!=cb){
+        if(ca==EOF || cb==EOF){
+          diff = -1;
+          break;
+        }
+        diff++;
+      }
+    }while(ca!=EOF);
+  }
+  if(fa){ fclose(fa); }
+  if(fb){ fclose(fb); }
+  return diff;
+}
+
+// Capture the display after the step, when the current transfer ends
+static void capture(const char *name){
+  transfers_t *t = &result[steps];
+  char out[64], ref[64];
+  uint16_t errors;
+  int32_t diff;
+
+  oledWait(oled.status!=oled_idle);
+  errors = hostOledCompare(oled.buffer, systemSettings.settings.OledOffset);
+  if(errors || hostOled.errors){
+    printf("FAIL: %s: %u pixels differ from the buffer, %u display errors\n", name, errors, hostOled.errors);
+    failed = 1;
+  }
+  snprintf(t->name, sizeof(t->name), "%s", name);
+  t->frames = oled.frames-lastFrames;
+  t->bytes = hostOled.bytes-lastBytes;
+  lastFrames = oled.frames;
+  lastBytes = hostOled.bytes;
+
+  snprintf(out, sizeof(out), "%s/%s.pbm", write ? SIM_GOLDEN : SIM_OUT, name);
+  snprintf(ref, sizeof(ref), SIM_GOLDEN"/%s.pbm", name);
+  if(!hostOledWritePBM(out, systemSettings.settings.OledOffset)){
+    exit(1);
+  }
+  printf("%-24s %4u frames %6u bytes", name, t->frames, t->bytes);
+  if(t->frames){
+    printf(" (%4u per frame)", t->bytes/t->frames);
+  }
+  if(!write){
+    diff = comparePBM(out, ref);
+    if(diff){
+      printf("\nFAIL: %s: ", name);
+      if(diff<0){
+        printf("no golden image %s", ref);
+      }
+      else{
+        printf("%d pixels differ from %s", diff, ref);
+      }
+      failed = 1;
+    }
+    if(steps<goldenSteps && !strcmp(golden[steps].name, name)){
+      if(t->bytes>golden[steps].bytes || t->frames>golden[steps].frames){
+        printf("\nFAIL: %s: transfers grew from %u frames, %u bytes", name, golden[steps].frames, golden[steps].bytes);
+        failed = 1;
+      }
+    }
+    else{
+      printf("\nFAIL: %s: not in "SIM_GOLDEN"/transfers.txt", name);
+      failed = 1;
+    }
+  }
+  printf("\n");
+  steps++;
+}
+
+static void rotate(RE_Rotation_t direction, uint8_t steps){
+  while(steps--){
+    simInput(direction);
+  }
+}
+
+int main(int argc, char **argv){
+  write = (argc>1 && !strcmp(argv[1], "-w"));
+  mkdir(write ? SIM_GOLDEN : SIM_OUT, 0755);
+  loadTransfers();
+
+  simBoot();
+  simRun(500);
+  capture("boot");                                                  // Splash screen
+
+  simRun(1000);
+  capture("first_boot");                                            // Settings flash empty, profile selection
+
+  simInput(Click);
+  simRun(1000);
+  capture("main_cold");
+
+  simTipTemp(178);
+  simRun(500);
+  capture("main_run");
+
+  simInput(Rotate_Increment);
+  capture("setpoint");
+
+  simRun(1500);                                                     // Back to the temperature
+  simInput(Click);
+  for(int16_t t=150; t<185; t++){                                   // Heating with the graph
+    simTipTemp(t);
+    simRun(60);
+  }
+  simTipTemp(180);
+  simRun(1000);
+  capture("graph");
+
+  simInput(Click);
+  simSupply(100);
+  simNoIron(1);
+  simRun(500);
+  capture("error");
+
+  simSupply(240);
+  simNoIron(0);
+  simRun(3000);
+  capture("error_cleared");
+
+  simInput(Rotate_Decrement_while_click);
+  simRun(300);
+  capture("standby");
+
+  simInput(Rotate_Decrement_while_click);
+  simRun(300);
+  capture("sleep");
+
+  simInput(LongClick);
+  simRun(300);
+  capture("settings_menu");
+
+  simInput(Click);
+  simRun(300);
+  capture("iron_menu");
+
+  rotate(Rotate_Increment, 30);                                     // Past the last item
+  simRun(300);
+  capture("iron_menu_end");
+
+  simInput(Click);                                                  // Back, then the system menu
+  simInput(Rotate_Increment);
+  simInput(Click);
+  simRun(300);
+  capture("system_menu");
+
+  rotate(Rotate_Increment, 6);
+  simRun(300);
+  capture("system_menu_scrolled");
+
+  if(write){
+    saveTransfers();
+    printf("Goldens written\n");
+    return 0;
+  }
+  if(failed){
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * plot_test.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host test of the main screen graph, scrolled by scrollPlot() when new samples come.
+ *
+ *  main_screen.c is built into this file to check its graph state. The main screen runs in graph mode with random
+ *  temperatures around the set point, and after every frame the plot area (x 13-112, y 16-55) must be the same as
+ *  drawing all the samples again.
+ *  Once with the default sample time (A sample every few frames), then with samples every 20mS (Several per frame).
+ */
+
+#include "sim_common.h"
+#include "main_screen.c"
+
+#define SIM_TIME          20000                                     // mS for each sample time
+
+// Pixels of the plot area different from drawing all the samples again
+static uint16_t checkPlot(void){
+  uint8_t *buffer = u8g2_GetBufferPtr(&u8g2);
+  uint16_t errors = 0;
+
+  for(uint8_t x=0; x<100; x++){
+    uint8_t height = plotHeight(x, plotSet, 1);
+    for(uint8_t y=16; y<56; y++){
+      bool pixel = (buffer[((y/8)*OledWidth)+x+13]>>(y%8))&1;
+      if(pixel!=(y>=56-height)){
+        errors++;
+      }
+    }
+  }
+  return errors;
+}
+
+static bool run(const char *name){
+  uint32_t checked=0, added=0, frames=frameStats.frames;
+
+  for(uint32_t ms=0; ms<SIM_TIME; ms++){
+    bool drawn = plotDrawn;
+    uint8_t index = plot_Index;
+
+    if(!(ms%10)){
+      simTipTemp(Iron.CurrentSetTemperature-25+(rand()%50));        // Around the set point, magnified graph +-20
+    }
+    simRun(1);
+    if(frameStats.frames==frames){
+      continue;
+    }
+    frames = frameStats.frames;
+    if(!plotDrawn){
+      printf("FAIL: %s: the graph is not shown\n", name);
+      return 0;
+    }
+    uint16_t errors = checkPlot();
+    if(errors){
+      printf("FAIL: %s: %u pixels differ from a full redraw at %umS\n", name, errors, ms);
+      return 0;
+    }
+    checked++;
+    if(drawn && index!=plot_Index){
+      added++;
+    }
+  }
+  printf("%-24s %5u frames checked, %5u adding samples to the graph\n", name, checked, added);
+  return 1;
+}
+
+int main(void){
+  simBoot();
+  simRun(1500);
+  simInput(Click);                                                  // First boot, default profile
+  simRun(1000);
+  simTipTemp(Iron.CurrentSetTemperature);
+  simRun(500);
+  simInput(Click);                                                  // Graph
+  simRun(500);
+
+  if(!run("default sample time")){
+    return 1;
+  }
+  systemSettings.Profile.readPeriod = (20*200)-1;                   // 20mS
+  if(!run("fast samples")){
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
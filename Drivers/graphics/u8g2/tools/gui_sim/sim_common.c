@@ -0,0 +1,208 @@
+/*
+ * sim_common.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  GUI built for the PC with the hardware I2C display transport (OLED_DEVICE), KSGER v2 board.
+ *
+ *  The whole GUI stack runs unmodified: screens, widgets, u8g2, ssd1306.c, settings, iron modes and sensor conversions.
+ *  The I2C transfers go to the emulated display (../host/ssd1306_host.c), so the image is what the display shows,
+ *  including the configuration commands, column offset and contrast.
+ *  The I2C transfers take the bus time (9 clocks per byte at SIM_I2C_KHZ). The data is on the display at the start,
+ *  the DMA completion is called by the time emulation when the transfer ends. The busy waits in ssd1306.c (oledWait)
+ *  make the time run, so the transfers complete the same as with the interrupts.
+ *  The control loop doesn't run, the iron state is set with the sensor readings (simTipTemp...) and the mode functions in iron.c.
+ */
+
+#include "sim_common.h"
+
+static GPIO_TypeDef portA, portB, portC;
+GPIO_TypeDef *GPIOA=&portA, *GPIOB=&portB, *GPIOC=&portC;
+static TIM_TypeDef tim3Regs, tim4Regs;
+TIM_HandleTypeDef htim3 = { &tim3Regs }, htim4 = { &tim4Regs };
+static DMA_Channel_TypeDef dma2Regs;
+DMA_HandleTypeDef hdma_memtomem_dma1_channel2 = { &dma2Regs };
+static I2C_TypeDef i2c2Regs;
+I2C_HandleTypeDef hi2c2 = { &i2c2Regs };
+ADC_HandleTypeDef hadc1;
+uint32_t SystemCoreClock = 36000000;
+
+static RE_Rotation_t input = Rotate_Nothing;                        // Encoder input for the next pass
+static bool i2cPending;                                             // DMA transfer running
+static uint64_t i2cEnd;                                             // Time when it ends
+static int16_t tipTemp;
+static bool tipPending;                                             // No tip loaded yet (First boot), set the reading later
+uint64_t simRenderNs;                                               // Host time of the passes rendering a frame
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Firmware functions, not used by the GUI
+//-------------------------------------------------------------------------------------------------------------------------------
+void _Error_Handler(char *file, int line){
+  fprintf(stderr, "Error_Handler %s:%d\n", file, line);
+  exit(3);
+}
+void NVIC_SystemReset(void){
+  fprintf(stderr, "Reset\n");
+  exit(3);
+}
+uint32_t getMicros(void){ return hostTime; }
+void HAL_Delay(uint32_t ms){ hostElapse(ms*1000); }
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init){}
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state){}
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin){ return GPIO_PIN_SET; }     // Button not pressed, iron out of the stand
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *h){ return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *h){ return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *h, uint32_t channel){ return HAL_OK; }
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *h){ return HAL_OK; }
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *h, ADC_ChannelConfTypeDef *c){ return HAL_OK; }
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *h){ return HAL_OK; }
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *h, uint32_t *data, uint32_t length){ return HAL_OK; }
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef *h){ return HAL_OK; }
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *h, uint32_t src, uint32_t dst, uint32_t length){ return HAL_ERROR; }  // dma_mem falls back to the CPU
+HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *h, uint32_t level, uint32_t timeout){ return HAL_OK; }
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *h){ return HAL_OK; }
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef *h, uint16_t address){ return HAL_OK; }
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Hardware I2C, memory writes to the emulated display
+//-------------------------------------------------------------------------------------------------------------------------------
+// Bus time of a memory write: address, memory address and data bytes
+static uint32_t i2cTime(uint16_t count){
+  return ((uint32_t)(count+2)*9*1000)/SIM_I2C_KHZ;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *h, uint16_t address, uint16_t memAddress, uint16_t memSize, uint8_t *data, uint16_t count, uint32_t timeout){
+  hostOledI2cWrite(address, memAddress, data, count);
+  hostElapse(i2cTime(count));
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *h, uint16_t address, uint16_t memAddress, uint16_t memSize, uint8_t *data, uint16_t count){
+  if(i2cPending){
+    return HAL_BUSY;
+  }
+  hostOledI2cWrite(address, memAddress, data, count);
+  i2cPending = 1;
+  i2cEnd = hostTime+i2cTime(count);
+  return HAL_OK;
+}
+
+// DMA completion interrupt. The callback starts the next transfer
+void hostOnElapse(uint32_t us){
+  if(i2cPending && hostTime>=i2cEnd){
+    i2cPending = 0;
+    HAL_I2C_MemTxCpltCallback(&hi2c2);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Encoder
+//-------------------------------------------------------------------------------------------------------------------------------
+static RE_Rotation_t simGetInput(RE_State_t *data){
+  RE_Rotation_t ret = input;
+
+  input = Rotate_Nothing;
+  data->Diff = (ret==Rotate_Increment || ret==Rotate_Increment_while_click) ? 1 :
+               (ret==Rotate_Decrement || ret==Rotate_Decrement_while_click) ? -1 : 0;
+  data->Rotation = ret;
+  return ret;
+}
+
+// Input taken in the next pass of the main loop, then 100mS to let the screen react
+void simInput(RE_Rotation_t in){
+  input = in;
+  simRun(100);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Sensors. The readings are set with the ADC values giving them, so the conversions in tempsensors.c are used
+//-------------------------------------------------------------------------------------------------------------------------------
+static void setAdc(volatile ADCDataTypeDef_t *adc, uint16_t value){
+  adc->last_avg = value;
+  adc->last_raw = value;
+  adc->EMA_of_Input = (uint32_t)value<<12;
+}
+
+static void setTip(void){
+  tipPending = (getCurrentTip()==NULL || systemSettings.setupMode==setup_On);
+  if(!tipPending){
+    setAdc(&TIP, human2adc(tipTemp));
+    readTipTemperatureCompensated(update_reading, read_Avg);
+  }
+}
+
+void simTipTemp(int16_t temp){
+  tipTemp = temp;
+  setTip();
+}
+
+void simNoIron(bool noIron){
+  TIP.last_raw = noIron ? 4095 : TIP.last_avg;
+}
+
+void simSupply(uint16_t v_x10){
+  uint16_t adc = 0;
+
+  setAdc(&VIN, adc);
+  while(adc<4095 && getSupplyVoltage_v_x10()<v_x10){
+    setAdc(&VIN, ++adc);
+  }
+}
+
+void simAmbient(int16_t temp_x10){
+  uint16_t adc = 4095;
+
+  setAdc(&NTC, adc);
+  while(adc && readColdJunctionSensorTemp_x10(mode_Celsius)<temp_x10){   // The NTC reading goes down with the temperature
+    setAdc(&NTC, --adc);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Main loop
+//-------------------------------------------------------------------------------------------------------------------------------
+// Host clock, in nS
+uint64_t simClock(void){
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return ((uint64_t)t.tv_sec*1000000000)+t.tv_nsec;
+}
+
+// Same steps as Init() in main.c, with the settings flash empty
+void simBoot(void){
+  hostFlashInit();
+  hostOledReset();
+  ssd1306_init(&hi2c2, &hdma_memtomem_dma1_channel2);
+  guiInit();
+  simSupply(240);
+  simAmbient(250);
+  restoreSettings();
+  ironInit(&htim4, &htim3, PWM_CHANNEL);
+  simTipTemp(25);
+  ssd1306_start();
+  RE_Init((RE_State_t *)&RE1_Data, ENC_L_GPIO_Port, ENC_L_Pin, ENC_R_GPIO_Port, ENC_R_Pin, ENC_SW_GPIO_Port, ENC_SW_Pin);
+  oled_init(&simGetInput, (RE_State_t *)&RE1_Data);
+}
+
+// Run the main loop, with the error checks done by the control loop. Each pass takes 1mS, simRenderNs adds the passes with a frame
+void simRun(uint32_t ms){
+  while(ms--){
+    for(uint8_t x=0; x<100; x++){                                   // In small steps, so the transfers end on time
+      hostElapse(10);
+    }
+    if(tipPending){
+      setTip();
+    }
+    checkIronError();
+    checkSettings();
+
+    uint32_t frames = frameStats.frames;
+    uint64_t start = simClock();
+    oled_handle();
+    if(frameStats.frames!=frames){
+      simRenderNs += simClock()-start;
+    }
+  }
+}
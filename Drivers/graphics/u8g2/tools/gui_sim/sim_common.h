@@ -0,0 +1,38 @@
+/*
+ * sim_common.h
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  GUI built for the PC, shared by the GUI host tools (gui_sim, gui_bench).
+ */
+
+#ifndef SIM_COMMON_H_
+#define SIM_COMMON_H_
+
+#include "hal_host.h"
+#include "ssd1306_host.h"
+#include "iron.h"
+#include "gui.h"
+#include "oled.h"
+#include "ssd1306.h"
+#include "adc_global.h"
+#include "tempsensors.h"
+#include "voltagesensors.h"
+#include "rotary_encoder.h"
+#include <time.h>
+
+#define SIM_I2C_KHZ       400                                       // Hardware I2C clock, for the transfer times
+
+extern uint64_t simRenderNs;
+
+void simBoot(void);
+void simRun(uint32_t ms);
+void simInput(RE_Rotation_t input);
+void simTipTemp(int16_t temp);
+void simNoIron(bool noIron);
+void simSupply(uint16_t v_x10);
+void simAmbient(int16_t temp_x10);
+uint64_t simClock(void);
+
+#endif /* SIM_COMMON_H_ */
@@ -0,0 +1,156 @@
+/*
+ * hal_host.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Emulated peripherals for the host builds.
+ *
+ *  The settings flash is mapped at FLASH_ADDR, so the firmware can read it directly as it does on the target.
+ *  Erase and program check the same conditions as the flash controller (Unlocked, aligned, programming only erased halfwords)
+ *  and take the datasheet time, so the iron timing can be checked.
+ *  A power cut can be set at any flash operation: the process exits leaving the operation half done.
+ *  The counters are shared like the flash, so the operations done by the processes killed by a power cut are counted.
+ */
+
+#include "hal_host.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+hostFlash_t *hostFlash;
+uint64_t hostTime;
+static bool locked = 1;
+
+static CRC_TypeDef crcRegs;
+CRC_HandleTypeDef hcrc = { &crcRegs };
+IWDG_HandleTypeDef hiwdg;
+
+void hostElapse(uint32_t us){
+  hostTime += us;
+  hostOnElapse(us);
+}
+
+uint32_t HAL_GetTick(void){
+  return hostTime/1000;
+}
+
+void HAL_IWDG_Refresh(IWDG_HandleTypeDef *h){
+  hostElapse(10);                                                   // Called in every busy loop, keep the time running
+}
+
+void __disable_irq(void){}
+void __enable_irq(void){}
+
+// STM32 CRC unit: CRC-32 (0x04C11DB7), 32-bit words, no reflection
+static uint32_t crcWord(uint32_t crc, uint32_t data){
+  crc ^= data;
+  for(uint8_t x=0; x<32; x++){
+    crc = (crc & 0x80000000) ? (crc<<1)^0x04C11DB7 : (crc<<1);
+  }
+  return crc;
+}
+
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef *h, uint32_t *data, uint32_t words){
+  if(h->Instance->CR & 1){                                          // __HAL_CRC_DR_RESET
+    h->Instance->DR = 0xFFFFFFFF;
+    h->Instance->CR &= ~1;
+  }
+  for(uint32_t x=0; x<words; x++){
+    uint32_t word;
+    memcpy(&word, &data[x], sizeof(uint32_t));
+    h->Instance->DR = crcWord(h->Instance->DR, word);
+  }
+  return h->Instance->DR;
+}
+
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *h, uint32_t *data, uint32_t words){
+  h->Instance->CR |= 1;
+  return HAL_CRC_Accumulate(h, data, words);
+}
+
+void hostFlashInit(void){
+  uintptr_t start = FLASH_ADDR & ~(uintptr_t)0xFFF;                 // Mapped in 4KB host pages, the storage is only page (1KB) aligned
+  void *flash = mmap((void*)start, (FLASH_ADDR-start)+(StoreSize*1024), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS|MAP_FIXED, -1, 0);
+
+  if(flash != (void*)start){                                        // Shared, so the contents survive the processes killed by power cuts
+    perror("mmap");
+    exit(1);
+  }
+  memset((void*)FLASH_ADDR, 0xFF, StoreSize*1024);
+  if(hostFlash==NULL){
+    hostFlash = mmap(NULL, sizeof(hostFlash_t), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(hostFlash==MAP_FAILED){
+      perror("mmap");
+      exit(1);
+    }
+  }
+  memset(hostFlash, 0, sizeof(hostFlash_t));
+  hostFlash->cutAt = -1;
+}
+
+// Write an image directly, as if it was left by other firmware
+void hostFlashLoad(const void *data, uint32_t offset, uint32_t size){
+  memcpy((uint8_t*)FLASH_ADDR+offset, data, size);
+}
+
+static bool powerCut(void){
+  return (hostFlash->cutAt>=0) && (hostFlash->ops==hostFlash->cutAt);
+}
+
+static void flashBusy(uint32_t us){
+  hostFlash->busy = 1;
+  hostElapse(us);
+  hostFlash->busy = 0;
+  hostFlash->ops++;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void){
+  locked = 0;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void){
+  locked = 1;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *erase, uint32_t *error){
+  uint8_t *page = (uint8_t*)(uintptr_t)erase->PageAddress;
+  uint32_t offset = erase->PageAddress-FLASH_ADDR;
+
+  if(locked || (erase->NbPages!=1) || (erase->PageAddress<FLASH_ADDR) || (offset>=StoreSize*1024) || (offset%FLASH_PAGE_SIZE)){
+    fprintf(stderr, "Bad erase at %08X\n", erase->PageAddress);
+    exit(2);
+  }
+  if(powerCut()){                                                   // Half erased page
+    memset(page, 0xFF, FLASH_PAGE_SIZE/2);
+    _exit(HOST_POWER_CUT);
+  }
+  flashBusy(HOST_ERASE_TIME);
+  memset(page, 0xFF, FLASH_PAGE_SIZE);
+  hostFlash->erases++;
+  hostFlash->pageErases[offset/FLASH_PAGE_SIZE]++;
+  *error = 0xFFFFFFFF;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t type, uint32_t address, uint64_t data){
+  uint16_t *dst = (uint16_t*)(uintptr_t)address;
+
+  if(locked || (type!=FLASH_TYPEPROGRAM_HALFWORD) || (address&1) || (address<FLASH_ADDR) || ((address+2)>(FLASH_ADDR+StoreSize*1024))){
+    fprintf(stderr, "Bad program at %08X\n", address);
+    exit(2);
+  }
+  if(*dst!=0xFFFF){
+    fprintf(stderr, "Programming a non erased halfword at %08X\n", address);
+    exit(2);
+  }
+  if(powerCut()){                                                   // Only some of the bits were programmed
+    *dst = (uint16_t)data | 0x5555;
+    _exit(HOST_POWER_CUT);
+  }
+  flashBusy(HOST_PROGRAM_TIME);
+  *dst = data;
+  hostFlash->programs++;
+  return HAL_OK;
+}
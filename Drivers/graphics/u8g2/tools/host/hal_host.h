@@ -0,0 +1,37 @@
+/*
+ * hal_host.h
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Emulated peripherals for the host builds: time, CRC unit and the settings flash.
+ */
+
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+#include "settings.h"
+
+#define HOST_POWER_CUT        99                                    // Exit code of a process killed by an emulated power cut
+#define HOST_ERASE_TIME       20000                                 // Page erase time, in uS (Datasheet: 20-40mS)
+#define HOST_PROGRAM_TIME     52                                    // Halfword programming time, in uS (Datasheet: 40-70uS)
+#define HOST_FLASH_PAGES      ((StoreSize*1024)/FLASH_PAGE_SIZE)
+
+typedef struct{
+  long          cutAt;                                              // Flash operation where the power is lost, -1 to disable
+  long          ops;                                                // Flash operations done (Erases + programmed halfwords)
+  uint32_t      erases;
+  uint32_t      programs;
+  uint32_t      pageErases[HOST_FLASH_PAGES];                       // Wear of each page
+  bool          busy;                                               // A flash operation is stalling the CPU
+}hostFlash_t;
+
+extern hostFlash_t *hostFlash;                                      // Shared by all the processes
+extern uint64_t hostTime;                                           // Emulated time, in uS
+
+void hostFlashInit(void);
+void hostFlashLoad(const void *data, uint32_t offset, uint32_t size);
+void hostElapse(uint32_t us);
+void hostOnElapse(uint32_t us);                                     // Called when the time advances, defined by each tool
+
+#endif /* HAL_HOST_H_ */
@@ -0,0 +1,295 @@
+/*
+ * ssd1306_host.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Emulated display for the host builds.
+ *
+ *  The RAM has the 132 columns of the SH1106, the panel shows 128 of them starting at the column offset (OledOffset).
+ *  Page addressing works in both controllers, horizontal addressing (Column and page range) is SSD1306 only, limited to 128 columns.
+ *  The panel is mounted with segment remap and COM scan reversed (0xA1, 0xC8), any other setting that changes the image
+ *  (Display on, charge pump, start line, offset, inverse, scroll) is applied to the shown pixels.
+ *  The I2C interface takes the pin levels after every change (hostOledBus), or whole transactions from the hardware I2C (hostOledI2cWrite).
+ *  The level of SDA is sampled on the rising edge of SCL, and the bit taken on the falling edge.
+ *  SDA changing with SCL high is a start or stop condition, discarding the sampled bit.
+ */
+
+#include "ssd1306_host.h"
+#include <stdio.h>
+#include <string.h>
+
+hostOled_t hostOled;
+
+void hostOledReset(void){
+  memset(&hostOled, 0, sizeof(hostOled));
+  memset(hostOled.gram, 0x55, sizeof(hostOled.gram));               // Random content after power up, any byte not sent shows up
+  hostOled.mode = 2;
+  hostOled.colEnd = 127;
+  hostOled.pageEnd = HOST_OLED_PAGES-1;
+  hostOled.contrast = 0x7F;
+  hostOled.scl = 1;                                                 // Idle bus, pulled up
+  hostOled.sda = 1;
+}
+
+// Parameter bytes of each command, including the command
+static uint8_t commandLength(uint8_t cmd){
+  switch(cmd){
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xAD: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 2;
+    case 0x21: case 0x22: case 0xA3:
+      return 3;
+    case 0x29: case 0x2A:
+      return 6;
+    case 0x26: case 0x27:
+      return 7;
+    default:
+      return 1;
+  }
+}
+
+static void command(uint8_t data){
+  uint8_t *cmd = hostOled.cmd;
+
+  cmd[hostOled.cmdLen++] = data;
+  if(hostOled.cmdLen < commandLength(cmd[0])){
+    return;
+  }
+  hostOled.cmdLen = 0;
+  if(cmd[0]<0x10){                                                  // Column start, lower nibble (Page mode)
+    hostOled.column = (hostOled.column&0xF0) | cmd[0];
+  }
+  else if(cmd[0]<0x20){                                             // Higher nibble
+    hostOled.column = (hostOled.column&0x0F) | ((cmd[0]&0x0F)<<4);
+  }
+  else if(cmd[0]>=0x40 && cmd[0]<=0x7F){                            // Display start line
+    hostOled.startLine = cmd[0]&0x3F;
+  }
+  else if(cmd[0]>=0xB0 && cmd[0]<=0xB7){                            // Page start (Page mode)
+    hostOled.page = cmd[0]&7;
+  }
+  else{
+    switch(cmd[0]){
+      case 0x20:
+        hostOled.mode = cmd[1]&3;
+        if(hostOled.mode==1 || hostOled.mode==3){                   // Vertical mode is never used
+          hostOled.errors++;
+        }
+        break;
+      case 0x21:                                                    // Checked when data is written, see data()
+        hostOled.colStart = hostOled.column = cmd[1]&0x7F;
+        hostOled.colEnd = cmd[2]&0x7F;
+        break;
+      case 0x22:
+        hostOled.pageStart = hostOled.page = cmd[1]&7;
+        hostOled.pageEnd = cmd[2]&7;
+        break;
+      case 0x2E: case 0x2F:
+        hostOled.scroll = cmd[0]&1;
+        break;
+      case 0x81:
+        hostOled.contrast = cmd[1];
+        break;
+      case 0x8D:
+        hostOled.chargePump = cmd[1]&4;
+        break;
+      case 0xA0: case 0xA1:
+        hostOled.remap = cmd[0]&1;
+        break;
+      case 0xA4: case 0xA5:
+        hostOled.entireOn = cmd[0]&1;
+        break;
+      case 0xA6: case 0xA7:
+        hostOled.inverse = cmd[0]&1;
+        break;
+      case 0xAE: case 0xAF:
+        hostOled.on = cmd[0]&1;
+        break;
+      case 0xC0: case 0xC8:
+        hostOled.comScan = cmd[0]&8;
+        break;
+      case 0xD3:
+        hostOled.displayOffset = cmd[1]&0x3F;
+        break;
+      default:                                                      // Configuration, not needed to show the RAM
+        break;
+    }
+  }
+}
+
+static void data(uint8_t data){
+  hostOled.dataBytes++;
+  if(hostOled.mode==0 && (hostOled.colStart>hostOled.colEnd || hostOled.pageStart>hostOled.pageEnd)){
+    if(!hostOled.errors){
+      fprintf(stderr, "Data sent to a bad window, columns %u-%u, pages %u-%u\n",
+              hostOled.colStart, hostOled.colEnd, hostOled.pageStart, hostOled.pageEnd);
+    }
+    hostOled.errors++;
+  }
+  if(hostOled.column<HOST_OLED_COLUMNS){
+    hostOled.gram[hostOled.page][hostOled.column] = data;
+  }
+  if(hostOled.mode==0){                                             // Horizontal, wraps to the next page of the window
+    if(hostOled.column>=hostOled.colEnd){
+      hostOled.column = hostOled.colStart;
+      hostOled.page = (hostOled.page>=hostOled.pageEnd) ? hostOled.pageStart : hostOled.page+1;
+    }
+    else{
+      hostOled.column++;
+    }
+  }
+  else{                                                             // Page, wraps in the same page
+    hostOled.column = (hostOled.column+1)%HOST_OLED_COLUMNS;
+  }
+}
+
+static void start(void){
+  if(hostOled.bits){
+    hostOled.truncated++;
+  }
+  hostOled.starts++;
+  hostOled.active = 1;
+  hostOled.bits = 0;
+  hostOled.index = 0;
+}
+
+static void stop(void){
+  if(hostOled.bits){
+    hostOled.truncated++;
+  }
+  hostOled.stops++;
+  hostOled.active = 0;
+  hostOled.bits = 0;
+}
+
+static void receive(uint8_t byte){
+  hostOled.bytes++;
+  if(hostOled.index++==0){
+    if(byte!=HOST_OLED_ADDRESS){                                    // Other address or a read, not acknowledged
+      hostOled.errors++;
+      hostOled.active = 0;
+    }
+    hostOled.control = 1;
+  }
+  else if(hostOled.control){
+    if(byte&0x3F){
+      hostOled.errors++;
+    }
+    hostOled.continuous = !(byte&0x80);
+    hostOled.dc = byte&0x40;
+    hostOled.control = 0;
+  }
+  else{
+    if(hostOled.dc){
+      data(byte);
+    }
+    else{
+      command(byte);
+    }
+    if(!hostOled.continuous){                                       // Co=1, a control byte follows each byte
+      hostOled.control = 1;
+    }
+  }
+}
+
+// New pin levels
+void hostOledBus(bool scl, bool sda){
+  bool sclEdge = (scl!=hostOled.scl), sdaEdge = (sda!=hostOled.sda);
+
+  if(sclEdge && sdaEdge){
+    hostOled.glitches++;
+  }
+  if(sdaEdge && scl && hostOled.scl){                               // Start or stop, the sampled bit is discarded
+    hostOled.sampled = 0;
+    if(sda){
+      stop();
+    }
+    else{
+      start();
+    }
+  }
+  else if(sclEdge && scl){
+    hostOled.sample = sda;
+    hostOled.sampled = 1;
+  }
+  else if(sclEdge && hostOled.sampled){
+    hostOled.sampled = 0;
+    if(hostOled.active && ++hostOled.bits<=8){
+      hostOled.data = (hostOled.data<<1) | hostOled.sample;
+      if(hostOled.bits==8){
+        receive(hostOled.data);
+      }
+    }
+    else{                                                           // ACK clock
+      hostOled.bits = 0;
+    }
+  }
+  hostOled.scl = scl;
+  hostOled.sda = sda;
+}
+
+// Complete transaction from the hardware I2C (Memory write, the control byte is the memory address)
+void hostOledI2cWrite(uint8_t address, uint8_t control, const uint8_t *data, uint16_t count){
+  start();
+  receive(address);
+  receive(control);
+  while(count--){
+    receive(*data++);
+  }
+  stop();
+}
+
+// Pixel shown by the panel at x,y
+static bool shownPixel(uint8_t x, uint8_t y, uint8_t offset){
+  uint8_t row, column;
+
+  if(!hostOled.on || !hostOled.chargePump){
+    return 0;
+  }
+  if(hostOled.entireOn){
+    return 1;
+  }
+  row = hostOled.comScan ? y : 63-y;
+  row = (row+hostOled.startLine+hostOled.displayOffset)%64;
+  column = x+offset;
+  if(!hostOled.remap){
+    column = (HOST_OLED_COLUMNS-1)-column;
+  }
+  return ((hostOled.gram[row/8][column]>>(row%8))&1) ^ hostOled.inverse;
+}
+
+// Number of pixels different from the buffer. Horizontal mode can only write the first 128 columns
+uint16_t hostOledCompare(const uint8_t *buffer, uint8_t offset){
+  uint8_t columns = (hostOled.mode==0) ? 128 : HOST_OLED_COLUMNS;
+  uint16_t errors = 0;
+
+  for(uint8_t y=0; y<64; y++){
+    for(uint8_t x=0; x<128 && (x+offset)<columns; x++){
+      bool pixel = (buffer[(128*(y/8))+x]>>(y%8))&1;
+
+      if(hostOled.scroll || shownPixel(x, y, offset)!=pixel){
+        errors++;
+      }
+    }
+  }
+  return errors;
+}
+
+// Save what the panel shows, same format as u8g2_WriteBufferPBM
+bool hostOledWritePBM(const char *path, uint8_t offset){
+  FILE *f = fopen(path, "w");
+
+  if(!f){
+    perror(path);
+    return 0;
+  }
+  fprintf(f, "P1\n128\n64\n");
+  for(uint8_t y=0; y<64; y++){
+    for(uint8_t x=0; x<128; x++){
+      fputs(((x+offset)<HOST_OLED_COLUMNS && shownPixel(x, y, offset)) ? "1" : "0", f);
+    }
+    fputs("\n", f);
+  }
+  fclose(f);
+  return 1;
+}
@@ -0,0 +1,56 @@
+/*
+ * ssd1306_host.h
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Emulated display for the host builds: SSD1306/SH1106 controller with its I2C interface.
+ */
+
+#ifndef SSD1306_HOST_H_
+#define SSD1306_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOST_OLED_ADDRESS     (0x3c<<1)
+#define HOST_OLED_COLUMNS     132                                   // SH1106 RAM. The panel shows 128 columns starting at the offset
+#define HOST_OLED_PAGES       8
+
+typedef struct{
+  uint8_t       gram[HOST_OLED_PAGES][HOST_OLED_COLUMNS];
+  uint8_t       mode;                                               // Addressing mode (0x20 command): 0 horizontal, 2 page
+  uint8_t       page, column;                                       // Write pointer
+  uint8_t       colStart, colEnd, pageStart, pageEnd;               // Horizontal mode window
+  uint8_t       contrast, startLine, displayOffset;
+  bool          on, inverse, entireOn, remap, comScan, chargePump, scroll;
+  uint8_t       cmd[8];                                             // Command being received, with its parameters
+  uint8_t       cmdLen;
+
+  // I2C interface
+  bool          scl, sda;
+  bool          sample, sampled;                                    // SDA at the last SCL rising edge, taken on the falling edge
+  bool          active;                                             // Addressed since the last start condition
+  uint8_t       bits;                                               // Clocks received in the current byte (The 9th is the ACK)
+  uint8_t       data;
+  uint16_t      index;                                              // Byte in the transaction (0 address, 1 control)
+  bool          control;                                            // Next byte is a control byte
+  bool          continuous;                                         // Control byte with Co=0, the rest are all data or commands
+  bool          dc;                                                 // Data (1) or commands (0)
+
+  // Stats, checked by the tests
+  uint32_t      starts, stops, bytes, dataBytes;
+  uint32_t      glitches;                                           // SDA changed with the SCL edge, the level seen by the display is undefined
+  uint32_t      truncated;                                          // Start or stop condition in the middle of a byte
+  uint32_t      errors;                                             // Wrong address, bad control byte, data sent to a bad window
+}hostOled_t;
+
+extern hostOled_t hostOled;
+
+void hostOledReset(void);
+void hostOledBus(bool scl, bool sda);
+void hostOledI2cWrite(uint8_t address, uint8_t control, const uint8_t *data, uint16_t count);
+uint16_t hostOledCompare(const uint8_t *buffer, uint8_t offset);
+bool hostOledWritePBM(const char *path, uint8_t offset);
+
+#endif /* SSD1306_HOST_H_ */
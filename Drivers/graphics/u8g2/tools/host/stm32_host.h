@@ -0,0 +1,283 @@
+/*
+ * stm32_host.h
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Minimal HAL replacement to build the firmware sources on a PC (Force included with -include, before board.h).
+ *  Only the types, macros and functions used by the project. See hal_host.c for the emulated peripherals.
+ */
+
+#ifndef STM32_HOST_H_
+#define STM32_HOST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#define __IO volatile
+typedef enum { HAL_OK=0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef enum { RESET=0, SET=1 } FlagStatus;
+typedef enum { GPIO_PIN_RESET=0, GPIO_PIN_SET } GPIO_PinState;
+typedef struct { volatile uint32_t CRL,CRH,IDR,ODR,BSRR,BRR,LCKR; } GPIO_TypeDef;
+typedef struct { uint32_t Pin, Mode, Pull, Speed; } GPIO_InitTypeDef;
+typedef struct { volatile uint32_t CR1,CR2,SMCR,DIER,SR,EGR,CCMR1,CCMR2,CCER,CNT,PSC,ARR,RCR,CCR1,CCR2,CCR3,CCR4,BDTR,DCR,DMAR; } TIM_TypeDef;
+typedef struct { uint32_t Prescaler, Period, CounterMode, ClockDivision, AutoReloadPreload; } TIM_Base_InitTypeDef;
+typedef struct { TIM_TypeDef *Instance; TIM_Base_InitTypeDef Init; void *hdma[7]; } TIM_HandleTypeDef;
+typedef struct { volatile uint32_t CCR, CNDTR, CPAR, CMAR; } DMA_Channel_TypeDef;
+typedef struct DMA_HandleTypeDef { DMA_Channel_TypeDef *Instance; struct { uint32_t Direction, PeriphInc, MemInc, PeriphDataAlignment, MemDataAlignment, Mode, Priority; } Init; void *Parent; void (*XferCpltCallback)(struct DMA_HandleTypeDef*); void (*XferHalfCpltCallback)(struct DMA_HandleTypeDef*); void (*XferErrorCallback)(struct DMA_HandleTypeDef*); volatile uint32_t State; } DMA_HandleTypeDef;
+typedef struct { volatile uint32_t CR1,CR2,SR,DR; } SPI_TypeDef;
+typedef struct { SPI_TypeDef *Instance; DMA_HandleTypeDef *hdmatx; volatile uint32_t State; uint32_t Lock; } SPI_HandleTypeDef;
+typedef struct { volatile uint32_t CR1,CR2; } I2C_TypeDef;
+typedef struct { uint32_t ClockSpeed,DutyCycle,OwnAddress1,AddressingMode,DualAddressMode,OwnAddress2,GeneralCallMode,NoStretchMode; } I2C_InitTypeDef;
+typedef struct { I2C_TypeDef *Instance; I2C_InitTypeDef Init; DMA_HandleTypeDef *hdmatx; volatile uint32_t State; uint32_t Lock; } I2C_HandleTypeDef;
+typedef struct { volatile uint32_t CHSELR; } ADC_TypeDef;
+typedef struct { uint32_t NbrOfConversion, ExternalTrigConv; } ADC_InitTypeDef;
+typedef struct { ADC_TypeDef *Instance; ADC_InitTypeDef Init; } ADC_HandleTypeDef;
+typedef struct { uint32_t Channel, Rank, SamplingTime; } ADC_ChannelConfTypeDef;
+typedef struct { int x; } IWDG_HandleTypeDef;
+typedef struct { volatile uint32_t DR, IDR, CR; } CRC_TypeDef;
+typedef struct { CRC_TypeDef *Instance; } CRC_HandleTypeDef;
+#define __HAL_CRC_DR_RESET(h) ((h)->Instance->CR |= 1)
+typedef struct { uint32_t TypeErase, Banks, PageAddress, NbPages; } FLASH_EraseInitTypeDef;
+typedef struct { volatile uint32_t ACR,KEYR,OPTKEYR,SR,CR,AR; } FLASH_TypeDef;
+extern FLASH_TypeDef *FLASH;
+typedef struct { volatile uint32_t CTRL, CYCCNT; } DWT_Type;
+extern DWT_Type *DWT;
+
+extern CRC_TypeDef *CRC;
+#define FLASH_PAGE_SIZE 0x400U
+#define FLASH_TYPEERASE_PAGES 0
+#define FLASH_TYPEPROGRAM_HALFWORD 1
+#define FLASH_TYPEPROGRAM_WORD 2
+#define FLASH_SR_BSY 1
+#define FLASH_SR_EOP 0x20
+#define FLASH_SR_PGERR 4
+#define FLASH_SR_WRPRTERR 0x10
+#define FLASH_CR_PG 1
+#define FLASH_CR_PER 2
+#define FLASH_CR_STRT 0x40
+#define FLASH_FLAG_EOP 0x20
+#define FLASH_FLAG_PGERR 4
+#define FLASH_FLAG_WRPERR 0x10
+#define GPIO_MODE_AF_PP 2
+#define GPIO_MODE_AF_OD 3
+#define GPIO_MODE_OUTPUT_PP 1
+#define GPIO_MODE_OUTPUT_OD 0x11
+#define GPIO_MODE_ANALOG 3
+#define GPIO_SPEED_FREQ_LOW 2
+#define GPIO_SPEED_FREQ_HIGH 3
+#define GPIO_NOPULL 0
+#define GPIO_PULLUP 1
+#define GPIO_PIN_0 1
+#define GPIO_PIN_1 2
+#define GPIO_PIN_2 4
+#define GPIO_PIN_3 8
+#define GPIO_PIN_4 0x10
+#define GPIO_PIN_5 0x20
+#define GPIO_PIN_6 0x40
+#define GPIO_PIN_7 0x80
+#define GPIO_PIN_8 0x100
+#define GPIO_PIN_9 0x200
+#define GPIO_PIN_10 0x400
+#define GPIO_PIN_11 0x800
+#define GPIO_PIN_12 0x1000
+#define GPIO_PIN_13 0x2000
+#define GPIO_PIN_14 0x4000
+#define GPIO_PIN_15 0x8000
+extern GPIO_TypeDef *GPIOA, *GPIOB, *GPIOC;
+#define TIM_CHANNEL_1 0
+#define TIM_CHANNEL_2 4
+#define TIM_CHANNEL_3 8
+#define TIM_CHANNEL_4 12
+#define TIM_FLAG_UPDATE 1
+#define TIM_FLAG_COM 0x20
+#define TIM_FLAG_CC1 2
+#define TIM_FLAG_CC2 4
+#define TIM_FLAG_CC3 8
+#define TIM_FLAG_CC4 0x10
+#define TIM_DMA_UPDATE 0x100
+#define TIM_DMA_ID_UPDATE 0
+#define ADC_CHANNEL_0 0
+#define ADC_CHANNEL_1 1
+#define ADC_CHANNEL_2 2
+#define ADC_CHANNEL_3 3
+#define ADC_CHANNEL_4 4
+#define ADC_CHANNEL_5 5
+#define ADC_CHANNEL_6 6
+#define ADC_CHANNEL_7 7
+#define ADC_CHANNEL_8 8
+#define ADC_CHANNEL_9 9
+#define ADC_CHANNEL_VREFINT 17
+#define ADC_SOFTWARE_START 0
+#define ADC_SAMPLETIME_13CYCLES_5 2
+#define ADC_REGULAR_RANK_1 1
+#define ADC_REGULAR_RANK_2 2
+#define ADC_REGULAR_RANK_3 3
+#define ADC_REGULAR_RANK_4 4
+#define ADC_RANK_CHANNEL_NUMBER 0x1000
+#define HAL_DMA_FULL_TRANSFER 0
+#define HAL_I2C_STATE_RESET 0
+#define I2C1 ((I2C_TypeDef*)0)
+#define I2C2 ((I2C_TypeDef*)0)
+#define I2C_DUTYCYCLE_2 0
+#define I2C_ADDRESSINGMODE_7BIT 0
+#define I2C_DUALADDRESS_DISABLE 0
+#define I2C_GENERALCALL_DISABLE 0
+#define I2C_NOSTRETCH_DISABLE 0
+#define DMA_CCR_EN 1
+#define DMA_IT_TC 2
+#define DMA_IT_HT 4
+#define HAL_DMA_STATE_READY 1
+#define HAL_DMA_STATE_BUSY 2
+#define DMA_MEMORY_TO_MEMORY 0x4000
+#define DMA_PINC_ENABLE 0x40
+#define DMA_PINC_DISABLE 0
+#define DMA_MINC_ENABLE 0x80
+#define DMA_MINC_DISABLE 0
+#define DMA_PDATAALIGN_WORD 0x200
+#define DMA_MDATAALIGN_WORD 0x800
+#define DMA_PDATAALIGN_BYTE 0
+#define DMA_MDATAALIGN_BYTE 0
+#define SPI_CR1_SPE 0x40
+#define SPI_SR_TXE 2
+#define SPI_SR_BSY 0x80
+extern uint32_t SystemCoreClock;
+void ITM_SendChar(uint32_t);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t);
+void HAL_IWDG_Refresh(IWDG_HandleTypeDef*);
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef*, uint32_t*, uint32_t);
+uint32_t HAL_CRC_Accumulate(CRC_HandleTypeDef*, uint32_t*, uint32_t);
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef*, uint32_t*);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t, uint32_t, uint64_t);
+void HAL_GPIO_Init(GPIO_TypeDef*, GPIO_InitTypeDef*);
+void HAL_GPIO_WritePin(GPIO_TypeDef*, uint16_t, GPIO_PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef*, uint16_t);
+void HAL_GPIO_TogglePin(GPIO_TypeDef*, uint16_t);
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef*, uint32_t);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef*, uint32_t);
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef*);
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef*, uint32_t, uint32_t, uint32_t);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef*, uint32_t, uint32_t, uint32_t);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef*);
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef*);
+HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef*, uint32_t, uint32_t);
+uint32_t HAL_DMA_GetState(DMA_HandleTypeDef*);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef*, uint8_t*, uint16_t, uint32_t);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef*, uint8_t*, uint16_t);
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef*);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef*, uint16_t, uint16_t, uint16_t, uint8_t*, uint16_t, uint32_t);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef*, uint16_t, uint16_t, uint16_t, uint8_t*, uint16_t);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef*, uint16_t, uint16_t, uint16_t, uint8_t*, uint16_t, uint32_t);
+HAL_StatusTypeDef HAL_I2C_Master_Abort_IT(I2C_HandleTypeDef*, uint16_t);
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef*, ADC_ChannelConfTypeDef*);
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef*);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef*, uint32_t*, uint32_t);
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef*);
+void NVIC_SystemReset(void);
+void __disable_irq(void);
+void __enable_irq(void);
+void __NOP(void);
+uint32_t __get_PRIMASK(void);
+#define __HAL_TIM_SET_COUNTER(h,v) ((h)->Instance->CNT=(v))
+#define __HAL_TIM_GET_COUNTER(h) ((h)->Instance->CNT)
+#define __HAL_TIM_SET_AUTORELOAD(h,v) ((h)->Instance->ARR=(v))
+#define __HAL_TIM_GET_AUTORELOAD(h) ((h)->Instance->ARR)
+#define __HAL_TIM_SET_COMPARE(h,c,v) ((h)->Instance->CCR1=(v))
+#define __HAL_TIM_GET_COMPARE(h,c) ((h)->Instance->CCR1)
+#define __HAL_TIM_CLEAR_FLAG(h,f) ((h)->Instance->SR=~(f))
+#define __HAL_TIM_ENABLE_DMA(h,f) ((h)->Instance->DIER|=(f))
+#define __HAL_TIM_DISABLE_DMA(h,f) ((h)->Instance->DIER&=~(f))
+#define __HAL_TIM_ENABLE(h) ((h)->Instance->CR1|=1)
+#define __HAL_TIM_DISABLE(h) ((h)->Instance->CR1&=~1)
+#define __HAL_UNLOCK(h) ((h)->Lock=0)
+#define __HAL_I2C_DISABLE(h) ((h)->Instance->CR1=0)
+#define __HAL_I2C_ENABLE(h) ((h)->Instance->CR1=1)
+#define __HAL_DMA_ENABLE_IT(h,f) ((h)->Instance->CCR|=(f))
+#define __HAL_DMA_DISABLE_IT(h,f) ((h)->Instance->CCR&=~(f))
+#define __HAL_DMA_ENABLE(h) ((h)->Instance->CCR|=1)
+#define __HAL_DMA_DISABLE(h) ((h)->Instance->CCR&=~1)
+#define __HAL_DMA_GET_COUNTER(h) ((h)->Instance->CNDTR)
+#define __HAL_FLASH_GET_FLAG(f) (FLASH->SR & (f))
+#define __HAL_FLASH_CLEAR_FLAG(f) (FLASH->SR = (f))
+#define __HAL_RCC_I2C1_FORCE_RESET() (void)0
+#define __HAL_RCC_I2C2_FORCE_RESET() (void)0
+#define __HAL_RCC_I2C1_RELEASE_RESET() (void)0
+#define __HAL_RCC_I2C2_RELEASE_RESET() (void)0
+#define __HAL_RCC_DMA1_CLK_ENABLE() (void)0
+#define __HAL_DBGMCU_FREEZE_IWDG() (void)0
+#define __HAL_DBGMCU_FREEZE_TIM3() (void)0
+#define __HAL_DBGMCU_FREEZE_TIM4() (void)0
+/* CubeMX generated handles */
+extern TIM_HandleTypeDef htim3, htim4, htim2, htim1, htim17, htim15, htim16, htim14;
+extern ADC_HandleTypeDef hadc1, hadc;
+extern SPI_HandleTypeDef hspi1, hspi2;
+extern I2C_HandleTypeDef hi2c1, hi2c2;
+extern DMA_HandleTypeDef hdma_memtomem_dma1_channel2;
+/* GPIO labels */
+#define PWM_GPIO_Port GPIOA
+#define PWM_Pin GPIO_PIN_1
+#define SW_SCL_GPIO_Port GPIOB
+#define SW_SCL_Pin GPIO_PIN_6
+#define SW_SDA_GPIO_Port GPIOB
+#define SW_SDA_Pin GPIO_PIN_7
+#define OLED_CS_GPIO_Port GPIOB
+#define OLED_CS_Pin GPIO_PIN_12
+#define OLED_DC_GPIO_Port GPIOB
+#define OLED_DC_Pin GPIO_PIN_11
+#define OLED_RST_GPIO_Port GPIOB
+#define OLED_RST_Pin GPIO_PIN_10
+#define WAKE_GPIO_Port GPIOA
+#define WAKE_Pin GPIO_PIN_2
+#define ENC_SW_GPIO_Port GPIOA
+#define ENC_SW_Pin GPIO_PIN_3
+#define ENC_L_GPIO_Port GPIOA
+#define ENC_L_Pin GPIO_PIN_4
+#define ENC_R_GPIO_Port GPIOA
+#define ENC_R_Pin GPIO_PIN_5
+#define BUZ0_GPIO_Port GPIOA
+#define BUZ0_Pin GPIO_PIN_6
+#define BUZ1_GPIO_Port GPIOA
+#define BUZ1_Pin GPIO_PIN_7
+#define BUZ2_GPIO_Port GPIOA
+#define BUZ2_Pin GPIO_PIN_8
+#define BUZ_GPIO_Port GPIOA
+#define BUZ_Pin GPIO_PIN_8
+#define BUZZER_GPIO_Port GPIOA
+#define BUZZER_Pin GPIO_PIN_8
+#define HW_SCL_GPIO_Port GPIOB
+#define HW_SCL_Pin GPIO_PIN_10
+#define HW_SDA_GPIO_Port GPIOB
+#define HW_SDA_Pin GPIO_PIN_11
+extern TIM_TypeDef *TIM2;
+#define TIM_CR1_CEN 1
+#define TIM_DIER_CC2DE 0x400
+#define TIM_EGR_UG 1
+extern DMA_Channel_TypeDef *DMA1_Channel7;
+#define DMA_MEMORY_TO_PERIPH 0x10
+#define DMA_CIRCULAR 0x20
+#define DMA_PRIORITY_LOW 0
+#define DMA1_Channel7_IRQn 17
+#define __HAL_RCC_TIM2_CLK_ENABLE() do{}while(0)
+#ifndef __HAL_RCC_DMA1_CLK_ENABLE
+#define __HAL_RCC_DMA1_CLK_ENABLE() do{}while(0)
+#endif
+void HAL_NVIC_SetPriority(int, uint32_t, uint32_t);
+void HAL_NVIC_EnableIRQ(int);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef*);
+#define DMA_CCR_PINC 0x40
+typedef struct { volatile uint32_t CTRL, LOAD, VAL, CALIB; } SysTick_Type;
+extern SysTick_Type *SysTick;
+#define cycleDelay(ns) do{}while(0)   /* SW I2C delays, the emulated display has no timing */
+void hostElapse(uint32_t us);
+#define oledWait(busy) while(busy){ hostElapse(1); }   /* Display busy waits take time, the emulated transfers complete meanwhile */
+
+#endif /* STM32_HOST_H_ */
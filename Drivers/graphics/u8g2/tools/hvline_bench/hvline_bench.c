@@ -0,0 +1,112 @@
+/*
+ * hvline_bench.c
+ *
+ *  Created on: Jul 25, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host benchmark for fastHVLine (Drivers/graphics/hvline.c) against u8g2_ll_hvline_vertical_top_lsb.
+ *  First checks both give the same buffer for lines and boxes at all positions and colors, then times them.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "u8g2.h"
+#include "hvline.h"
+
+#define RUNS    200000
+
+static uint8_t bufU8g2[1024] __attribute__((aligned(4)));
+static uint8_t bufFast[1024] __attribute__((aligned(4)));
+static u8g2_t u8g2Ref, u8g2Fast;
+
+static void setup(u8g2_t *u8g2, uint8_t *buf, u8g2_draw_ll_hvline_cb hvline){
+  u8g2_SetupDisplay(u8g2, u8x8_d_ssd1306_128x64_noname, u8x8_cad_001, u8x8_dummy_cb, u8x8_dummy_cb);
+  u8g2_SetupBuffer(u8g2, buf, 8, hvline, U8G2_R0);
+  u8g2_InitDisplay(u8g2);
+}
+
+static double now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + (t.tv_nsec*1e-9);
+}
+
+typedef struct{
+  const char *name;
+  void (*draw)(u8g2_t *u8g2, uint32_t n);
+}test_t;
+
+static void drawHLine(u8g2_t *u8g2, uint32_t n){ u8g2_DrawHLine(u8g2, n%8, n%64, 100+(n%20)); }
+static void drawVLine(u8g2_t *u8g2, uint32_t n){ u8g2_DrawVLine(u8g2, n%128, n%8, 40+(n%16)); }
+static void drawBox(u8g2_t *u8g2, uint32_t n){ u8g2_DrawBox(u8g2, n%8, n%8, 100, 14); }
+static void drawFrame(u8g2_t *u8g2, uint32_t n){ u8g2_DrawFrame(u8g2, n%8, n%8, 100, 14); }
+static void clearField(u8g2_t *u8g2, uint32_t n){ u8g2_DrawBox(u8g2, 0, 17+(n%8), 128, 24); }
+
+static const test_t tests[] = {
+    { "hline 100-120",  drawHLine },
+    { "vline 40-56",    drawVLine },
+    { "box 100x14",     drawBox },
+    { "frame 100x14",   drawFrame },
+    { "box 128x24",     clearField },
+};
+
+static int check(void){
+  int errors=0, cases=0;
+  for(uint8_t color=0; color<3; color++){
+    u8g2_SetDrawColor(&u8g2Ref, color);
+    u8g2_SetDrawColor(&u8g2Fast, color);
+    for(int y=0; y<64; y++){
+      for(int x=0; x<128; x++){
+        for(int len=1; len<=128; len+=(len<16) ? 1 : 13){
+          for(uint8_t dir=0; dir<3; dir++){
+            memset(bufU8g2, 0x5A, sizeof(bufU8g2));
+            memcpy(bufFast, bufU8g2, sizeof(bufFast));
+            if(dir==0){
+              u8g2_DrawHLine(&u8g2Ref, x, y, len);
+              u8g2_DrawHLine(&u8g2Fast, x, y, len);
+            }
+            else if(dir==1){
+              u8g2_DrawVLine(&u8g2Ref, x, y, len);
+              u8g2_DrawVLine(&u8g2Fast, x, y, len);
+            }
+            else{
+              u8g2_DrawBox(&u8g2Ref, x, y, len, (len%40)+1);
+              u8g2_DrawBox(&u8g2Fast, x, y, len, (len%40)+1);
+            }
+            cases++;
+            if(memcmp(bufU8g2, bufFast, sizeof(bufU8g2)) && errors++<10){
+              printf("Mismatch: color %u, x %d, y %d, len %d, %s\n", color, x, y, len, (dir==0) ? "hline" : (dir==1) ? "vline" : "box");
+            }
+          }
+        }
+      }
+    }
+  }
+  printf("%d/%d cases match\n\n", cases-errors, cases);
+  return errors;
+}
+
+int main(void){
+  setup(&u8g2Ref, bufU8g2, u8g2_ll_hvline_vertical_top_lsb);
+  setup(&u8g2Fast, bufFast, fastHVLine);
+
+  if(check()){
+    return 1;
+  }
+  printf("%-16s %12s %12s %8s\n", "Test", "u8g2 ns", "fast ns", "Speedup");
+  for(uint8_t t=0; t<sizeof(tests)/sizeof(test_t); t++){
+    double time[2];
+    for(uint8_t i=0; i<2; i++){
+      u8g2_t *u8g2 = i ? &u8g2Fast : &u8g2Ref;
+      u8g2_SetDrawColor(u8g2, 2);
+      double start = now();
+      for(uint32_t n=0; n<RUNS; n++){
+        tests[t].draw(u8g2, n);
+      }
+      time[i] = (now()-start)*1e9/RUNS;
+    }
+    printf("%-16s %12.1f %12.1f %7.1fx\n", tests[t].name, time[0], time[1], time[0]/time[1]);
+  }
+  return 0;
+}
@@ -0,0 +1,291 @@
+/*
+ * oled_sim.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host test of the background transport for software I2C displays (OLED_TIM_DMA in ssd1306.c), KSGER v2 board.
+ *
+ *  TIM2 and DMA1 channel 7 are emulated: each timer period the DMA writes the next word of the circular stream to the
+ *  port BSRR, and the pin levels go to the emulated display (../host/ssd1306_host.c), which decodes the I2C into its RAM.
+ *  The DMA interrupt is serviced a number of words after its flag is set, to emulate the latency of the higher priority interrupts.
+ *
+ *  Checks:
+ *  - SDA never changes in the same word as SCL, no start or stop condition in the middle of a byte, no bad commands.
+ *  - The display shows the buffer after each update. Random frames and partial changes, column offset 0 and 2.
+ *  - No frame is aborted with the interrupt serviced within SIM_LATENCY words.
+ *  - A late interrupt aborts the frame (oled.underruns), the next update clears the bus and repairs the display.
+ *
+ *  Built for page addressing (oled_sim) and horizontal addressing (oled_sim_h, -DOLED_HORIZONTAL).
+ */
+
+#include "hal_host.h"
+#include "ssd1306_host.h"
+#include "ssd1306.h"
+#include "buzzer.h"
+#include "hvline.h"
+#include "width_cache.h"
+
+#define SIM_FRAMES        400                                       // Frames for each offset and latency
+#define SIM_LATENCY       100                                       // Max latency that must work, in DMA words. Half buffer: 108 words
+#define SIM_LATE          120                                       // Latency past the half buffer, the DMA wraps before the refill
+#define SIM_WORD_NS       I2C_HIGH_NS                               // Timer period
+
+#ifdef OLED_HORIZONTAL
+#define SIM_MODE          0x00
+#else
+#define SIM_MODE          0x02
+#endif
+
+static GPIO_TypeDef portA, portB, portC;
+GPIO_TypeDef *GPIOA=&portA, *GPIOB=&portB, *GPIOC=&portC;
+static TIM_TypeDef tim2Regs;
+TIM_TypeDef *TIM2 = &tim2Regs;
+static DMA_Channel_TypeDef dma7Regs;
+DMA_Channel_TypeDef *DMA1_Channel7 = &dma7Regs;
+uint32_t SystemCoreClock = 36000000;
+systemSettings_t systemSettings;
+u8g2_t u8g2;
+
+static DMA_HandleTypeDef *streamDMA;
+static uint16_t streamLength;
+static uint8_t pending;                                             // DMA interrupt flags
+static uint32_t pins = SW_SCL_Pin | SW_SDA_Pin;                     // Port output, idle bus
+static uint64_t words;                                              // Words written by the DMA
+
+void DMA1_Channel7_IRQHandler(void);                                // ssd1306.c
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Firmware functions used by ssd1306.c, not needed for the transport
+//-------------------------------------------------------------------------------------------------------------------------------
+void _Error_Handler(char *file, int line){
+  fprintf(stderr, "Error_Handler %s:%d\n", file, line);
+  exit(3);
+}
+void NVIC_SystemReset(void){ exit(3); }
+void Diag_init(void){}
+void setSettingsDirty(void){}
+void setSafeMode(bool mode){}
+void buzzer_fatal_beep(void){}
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init){}
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin){ return GPIO_PIN_SET; }
+void HAL_NVIC_SetPriority(int irq, uint32_t priority, uint32_t sub){}
+void HAL_NVIC_EnableIRQ(int irq){}
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *h, uint32_t src, uint32_t dst, uint32_t length){ return HAL_ERROR; }
+HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *h, uint32_t level, uint32_t timeout){ return HAL_OK; }
+void fastHVLine(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir){}
+u8g2_uint_t cachedStrWidth(u8g2_t *u8g2, const char *str){ return 0; }
+u8g2_uint_t u8g2_DrawStr(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, const char *str){ return 0; }
+void hostOnElapse(uint32_t us){}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// TIM2 + DMA1 channel 7
+//-------------------------------------------------------------------------------------------------------------------------------
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *h){
+  h->State = HAL_DMA_STATE_READY;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *h, uint32_t src, uint32_t dst, uint32_t length){
+  if(h->Instance!=DMA1_Channel7 || dst!=(uint32_t)(uintptr_t)&SW_SCL_GPIO_Port->BSRR || h->Init.Mode!=DMA_CIRCULAR || (length&1)){
+    fprintf(stderr, "Bad stream DMA setup\n");
+    exit(3);
+  }
+  h->Instance->CMAR = src;
+  h->Instance->CPAR = dst;
+  h->Instance->CNDTR = length;
+  h->Instance->CCR |= DMA_CCR_EN | DMA_IT_TC | DMA_IT_HT;
+  h->State = HAL_DMA_STATE_BUSY;
+  streamDMA = h;
+  streamLength = length;
+  pending = 0;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *h){
+  h->Instance->CCR &= ~(DMA_CCR_EN | DMA_IT_TC | DMA_IT_HT);
+  h->State = HAL_DMA_STATE_READY;
+  pending = 0;
+  return HAL_OK;
+}
+
+// Same order as the HAL, one callback per call
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *h){
+  if(pending & DMA_IT_HT){
+    pending &= ~DMA_IT_HT;
+    h->XferHalfCpltCallback(h);
+  }
+  else if(pending & DMA_IT_TC){
+    pending &= ~DMA_IT_TC;
+    h->XferCpltCallback(h);
+  }
+}
+
+// One timer period, the DMA writes the next word to the port
+static void timerTick(void){
+  if(!(TIM2->CR1 & TIM_CR1_CEN) || !(DMA1_Channel7->CCR & DMA_CCR_EN)){
+    return;
+  }
+  uint32_t word = ((uint32_t*)(uintptr_t)DMA1_Channel7->CMAR)[streamLength-DMA1_Channel7->CNDTR];
+
+  pins = (pins & ~(word>>16)) | (word & 0xFFFF);                    // BSRR, set has priority over reset
+  hostOledBus(pins & SW_SCL_Pin, pins & SW_SDA_Pin);
+  words++;
+  if(--DMA1_Channel7->CNDTR==streamLength/2){
+    pending |= DMA_IT_HT;
+  }
+  else if(DMA1_Channel7->CNDTR==0){
+    pending |= DMA_IT_TC;
+    DMA1_Channel7->CNDTR = streamLength;                            // Circular
+  }
+}
+
+// Run until the frame is sent. The interrupt is serviced <latency> words after the flag
+static void transfer(uint16_t latency){
+  uint64_t start = words;
+  uint16_t wait = 0;
+
+  while(oled.status!=oled_idle){
+    timerTick();
+    if(pending && ++wait>latency){
+      while(pending && oled.status!=oled_idle){
+        DMA1_Channel7_IRQHandler();
+      }
+      wait = 0;
+    }
+    if(words-start > 100000){
+      printf("FAIL: Transfer not finished\n");
+      exit(1);
+    }
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Tests
+//-------------------------------------------------------------------------------------------------------------------------------
+static unsigned seed = 1;
+
+static void draw(uint32_t frame){
+  switch(frame%4){
+    case 0:                                                         // New screen
+      for(uint16_t x=0; x<sizeof(oled.buffer); x++){
+        oled.buffer[x] = rand_r(&seed);
+      }
+      break;
+    case 1:                                                         // Some digits changed
+      for(uint8_t x=rand_r(&seed)%6; x; x--){
+        oled.buffer[rand_r(&seed)%sizeof(oled.buffer)] ^= 1<<(rand_r(&seed)%8);
+      }
+      break;
+    case 2:                                                         // A page redrawn
+    {
+      uint8_t page = rand_r(&seed)%8;
+      for(uint8_t x=0; x<128; x++){
+        oled.buffer[(128*page)+x] = rand_r(&seed);
+      }
+      break;
+    }
+    default:                                                        // Nothing changed
+      break;
+  }
+}
+
+// Power up the display. ssd1306_start sends the configuration in blocking mode, not seen by the emulated port.
+// Only the commands changing the image
+static void startDisplay(uint8_t offset){
+  static const uint8_t config[] = { 0x20, SIM_MODE, 0xA1, 0xC8, 0x8D, 0x14, 0xAF };
+
+  hostOledReset();
+  hostOledI2cWrite(HOST_OLED_ADDRESS, i2cCmd, config, sizeof(config));
+  systemSettings.settings.OledOffset = offset;
+  memset(oled.buffer, 0, sizeof(oled.buffer));
+}
+
+static bool check(const char *name, uint32_t frame){
+  uint16_t errors = hostOledCompare(oled.buffer, systemSettings.settings.OledOffset);
+
+  if(errors || hostOled.glitches || hostOled.truncated || hostOled.errors || hostOled.starts!=hostOled.stops){
+    printf("FAIL: %s, offset %u, frame %u: %u pixels differ, %u glitches, %u truncated bytes, %u errors, %u starts, %u stops\n",
+           name, systemSettings.settings.OledOffset, frame, errors, hostOled.glitches, hostOled.truncated, hostOled.errors,
+           hostOled.starts, hostOled.stops);
+    return 0;
+  }
+  return 1;
+}
+
+static bool testFrames(uint8_t offset, uint16_t latency){
+  uint32_t frames = oled.frames, bytes = oled.bytes;
+  uint64_t start = words;
+  char name[32];
+
+  snprintf(name, sizeof(name), "Latency %u", latency);
+  startDisplay(offset);
+  for(uint32_t frame=0; frame<SIM_FRAMES; frame++){
+    draw(frame);
+    update_display();
+    transfer(latency);
+    if(!check(name, frame)){
+      return 0;
+    }
+  }
+  if(oled.underruns){
+    printf("FAIL: %s, offset %u: %u frames aborted\n", name, offset, oled.underruns);
+    return 0;
+  }
+  frames = oled.frames-frames;
+  bytes = oled.bytes-bytes;
+  printf("Offset %u, latency %3u words: %4u frames OK, %6.1f bytes and %7.1f uS per frame (%.0fkHz clock)\n",
+         offset, latency, frames, (double)bytes/frames, (double)(words-start)*SIM_WORD_NS/1000/frames, 1e6/(3*SIM_WORD_NS));
+  return 1;
+}
+
+static bool testUnderrun(uint8_t offset){
+  uint32_t underruns = oled.underruns;
+
+  startDisplay(offset);
+  for(uint32_t frame=0; frame<SIM_FRAMES; frame++){
+    draw(frame);
+    update_display();
+    transfer(SIM_LATE);
+    if(oled.row!=0 || (oled.dirty && oled.underruns==underruns)){
+      printf("FAIL: Late interrupt, offset %u, frame %u: status not reset\n", offset, frame);
+      return 0;
+    }
+    hostOled.glitches = hostOled.truncated = hostOled.errors = 0;   // The aborted frame leaves garbage
+    hostOled.starts = hostOled.stops = 0;
+    update_display();                                               // Bus clear and everything sent again
+    transfer(0);
+    if(hostOled.truncated<=1 && hostOled.stops>=2){                 // The bus clear has two stops, the first one discards the partial byte
+      hostOled.truncated = 0;
+      hostOled.stops -= 2;
+    }
+    if(!check("Recovery", frame)){
+      return 0;
+    }
+  }
+  if(oled.underruns-underruns < SIM_FRAMES/2){
+    printf("FAIL: Late interrupt, offset %u: only %u underruns detected\n", offset, oled.underruns-underruns);
+    return 0;
+  }
+  printf("Offset %u, latency %3u words: %4u frames aborted and repaired\n", offset, SIM_LATE, oled.underruns-underruns);
+  oled.underruns = 0;
+  return 1;
+}
+
+int main(void){
+  ssd1306_init(NULL);
+  oled.started = 1;
+  oled.use_sw = 1;
+  for(uint8_t offset=0; offset<=2; offset+=2){
+    for(uint16_t latency=0; latency<=SIM_LATENCY; latency+=SIM_LATENCY/4){
+      if(!testFrames(offset, latency)){
+        return 1;
+      }
+    }
+    if(!testUnderrun(offset)){
+      return 1;
+    }
+  }
+  printf("OK\n");
+  return 0;
+}
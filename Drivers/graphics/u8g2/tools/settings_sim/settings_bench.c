@@ -0,0 +1,220 @@
+/*
+ * settings_bench.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host benchmark of the settings storage (Core/Src/settings.c) with the emulated flash (../host/hal_host.c).
+ *
+ *  Replays BENCH_DAYS days of use: each day boots the station, does some temperature edits with the knob, tip changes
+ *  and a profile switch and back, with the iron running and the main loop calling checkSettings every mS.
+ *  Some days the power is lost at a random flash operation, the next boot must still load the settings.
+ *  Shows the flash usage (Saves, erases of each page, bytes written), the save latency, the CPU stalls,
+ *  the host CPU time of restoreSettings and loadProfile, and the projected flash life.
+ *
+ *  Each day runs in its own process, the flash and its counters are shared, like in settings_sim.
+ */
+
+#include "sim_common.h"
+#include <sys/mman.h>
+#include <time.h>
+
+#define BENCH_DAYS        365
+#define BENCH_EDITS       20                                        // Temperature edits per day
+#define BENCH_STEPS       6                                         // Knob steps in each edit
+#define BENCH_TIPS        5                                         // Tips in the T12 profile
+#define BENCH_TIP_EVERY   5                                         // Tip change every 5 edits
+#define BENCH_CUT_EVERY   7                                         // Power cut at a random flash operation once a week
+
+typedef struct{
+  uint32_t      saves;
+  uint32_t      bytesWritten;
+  uint64_t      saveTime;                                           // Sum of the save latencies, in mS
+  uint32_t      maxSaveTime;
+  uint16_t      maxStall;
+  uint32_t      overruns;
+  uint32_t      missedReadings;
+  uint32_t      boots;
+  uint64_t      bootNs;
+  uint32_t      loads;
+  uint64_t      loadNs;
+  uint32_t      savesLeft;                                          // Firmware estimation (getFlashSavesLeft)
+  uint16_t      expected;                                           // Temperature stored by the previous day
+  bool          check;                                              // Previous day completed, check the temperature on boot
+}benchResults_t;
+
+static benchResults_t *results;
+static uint32_t lastSaves;
+
+static uint64_t hostNs(void){
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return ((uint64_t)t.tv_sec*1000000000)+t.tv_nsec;
+}
+
+// Main loop: checkSettings every mS
+static void work(uint32_t ms){
+  for(uint32_t x=0; x<ms; x++){
+    hostElapse(1000);
+    checkSettings();
+    if(flashStats.saves!=lastSaves){
+      lastSaves = flashStats.saves;
+      results->saveTime += flashStats.lastSaveTime;
+    }
+  }
+}
+
+static void benchBoot(void){
+  uint64_t start = hostNs();
+
+  boot();
+  results->bootNs += hostNs()-start;
+  results->boots++;
+  lastSaves = 0;
+  Iron.Read_Timer = &readTimer;
+}
+
+static void benchLoadProfile(uint8_t profile){
+  uint64_t start = hostNs();
+
+  loadProfile(profile);
+  results->loadNs += hostNs()-start;
+  results->loads++;
+  saveSettingsFromMenu(save_Settings);                              // Like the settings menu does
+}
+
+// Collect the stats of this process. Lost if the day ends with a power cut
+static void endDay(void){
+  results->saves += flashStats.saves;
+  results->bytesWritten += flashStats.bytesWritten;
+  results->overruns += flashStats.overruns;
+  results->missedReadings += missedReadings;
+  if(flashStats.maxSaveTime > results->maxSaveTime){
+    results->maxSaveTime = flashStats.maxSaveTime;
+  }
+  if(flashStats.maxStall > results->maxStall){
+    results->maxStall = flashStats.maxStall;
+  }
+  results->savesLeft = getFlashSavesLeft();
+  results->expected = systemSettings.Profile.UserSetTemperature;
+}
+
+// First boot: T12 profile with some tips
+static void childSetup(int arg){
+  benchBoot();
+  loadProfile(profile_T12);
+  for(uint8_t x=1; x<BENCH_TIPS; x++){
+    tipData tip;
+
+    getTipData(0, &tip);
+    tip.name[TipCharSize-2] = '0'+x;
+    tip.calADC_At_350 += x;
+    setProfileValue(currentNumberOfTips, x+1);
+    setTipData(x, &tip);
+  }
+  saveSettings(keepProfiles);
+  endDay();
+}
+
+static void childDay(int day){
+  srand(day);                                                       // Same edits whatever the power cuts were
+  benchBoot();
+  if(errorShown){
+    fprintf(stderr, "Day %d: Error screen on boot\n", day);
+    exit(5);
+  }
+  if(results->check && (systemSettings.Profile.UserSetTemperature!=results->expected)){
+    fprintf(stderr, "Day %d: Temperature %u, expected %u\n", day, systemSettings.Profile.UserSetTemperature, results->expected);
+    exit(6);
+  }
+  for(uint8_t edit=0; edit<BENCH_EDITS; edit++){
+    int8_t step = ((rand()%2) ? 1 : -1) * systemSettings.settings.tempStep;
+
+    for(uint8_t x=0; x<BENCH_STEPS; x++){                           // Knob turned, one step every 150mS
+      uint16_t temperature = systemSettings.Profile.UserSetTemperature+step;
+
+      if((temperature>=systemSettings.Profile.MinSetTemperature) && (temperature<=systemSettings.Profile.MaxSetTemperature)){
+        setProfileValue(UserSetTemperature, temperature);
+      }
+      work(150);
+    }
+    work(20*1000);                                                  // Soldering, saved after saveSettingsDelay
+    if((edit%BENCH_TIP_EVERY)==BENCH_TIP_EVERY-1){
+      setCurrentTip((systemSettings.Profile.currentTip+1)%systemSettings.Profile.currentNumberOfTips);
+      work(20*1000);
+    }
+  }
+  benchLoadProfile(profile_C245);                                   // Profile switch and back
+  work(60*1000);
+  benchLoadProfile(profile_T12);
+  work(60*1000);
+  finishSaving();
+  endDay();
+}
+
+int main(void){
+  uint32_t cuts=0, lastOps=0;
+  unsigned seed=1;
+
+  results = mmap(NULL, sizeof(benchResults_t), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+  if(results==MAP_FAILED){
+    perror("mmap");
+    return 1;
+  }
+  memset(results, 0, sizeof(benchResults_t));
+  hostFlashInit();
+  if(run(childSetup, 0)){
+    printf("FAIL: Setup\n");
+    return 1;
+  }
+  results->check = 1;
+  for(int day=0; day<BENCH_DAYS; day++){
+    long ops = hostFlash->ops;
+
+    if(((day%BENCH_CUT_EVERY)==BENCH_CUT_EVERY-1) && lastOps){
+      hostFlash->cutAt = ops+(rand_r(&seed)%lastOps);
+    }
+    int status = run(childDay, day);
+    hostFlash->cutAt = -1;
+    lastOps = hostFlash->ops-ops;
+    if(status==HOST_POWER_CUT){
+      cuts++;
+      results->check = 0;                                           // The last edits might be lost
+    }
+    else if(status){
+      printf("FAIL: Day %d, exit %d\n", day, status);
+      return 1;
+    }
+    else{
+      results->check = 1;
+    }
+  }
+
+  uint32_t maxErases = 0;
+  double days = BENCH_DAYS;
+
+  printf("%d days: %d temperature edits, %d tip changes and a profile switch and back each day, %u power cuts\n",
+         BENCH_DAYS, BENCH_EDITS, BENCH_EDITS/BENCH_TIP_EVERY, cuts);
+  printf("Saves:              %8u  %6.1f per day (Not counting the days ending with a power cut)\n", results->saves, results->saves/days);
+  printf("Bytes written:      %8u  %6.1f per save\n", results->bytesWritten, results->saves ? (double)results->bytesWritten/results->saves : 0);
+  printf("Page erases:       ");
+  for(uint8_t x=0; x<HOST_FLASH_PAGES; x++){
+    printf(" %u", hostFlash->pageErases[x]);
+    if(hostFlash->pageErases[x] > maxErases){
+      maxErases = hostFlash->pageErases[x];
+    }
+  }
+  printf("  (%u total, %u halfwords programmed)\n", hostFlash->erases, hostFlash->programs);
+  printf("Save latency:       %6.1f mS average, %u mS max (From the change detection to the commit)\n",
+         results->saves ? (double)results->saveTime/results->saves : 0, results->maxSaveTime);
+  printf("CPU stalls:         %6u uS max, %u flash operations over the PWM window, %u ADC readings delayed\n",
+         results->maxStall*5, results->overruns, results->missedReadings);
+  printf("restoreSettings:    %6.1f uS average (Host CPU), %u boots\n", results->boots ? results->bootNs/1000.0/results->boots : 0, results->boots);
+  printf("loadProfile:        %6.1f uS average (Host CPU), %u loads\n", results->loads ? results->loadNs/1000.0/results->loads : 0, results->loads);
+  if(maxErases){
+    printf("Projected life:     %6.1f years (%d erases of the most used page), firmware estimation: %u saves left\n",
+           FLASH_ENDURANCE/(maxErases/days)/365, FLASH_ENDURANCE, results->savesLeft);
+  }
+  return 0;
+}
@@ -0,0 +1,551 @@
+/*
+ * settings_sim.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Host test of the settings storage (Core/Src/settings.c) with the emulated flash (../host/hal_host.c).
+ *
+ *  Power cuts: a save is interrupted at every flash operation, one by one, and the station is booted again.
+ *  The boot must find either the previous data or the new one, never a mix or an error.
+ *
+ *  Iron timing: background saves must never stall the CPU over an ADC reading while the iron is running.
+ *
+ *  Migration: images of every past settings version are built here, byte by byte from their layout (Not with the firmware code),
+ *  and the firmware must convert them keeping all the values.
+ *
+ *  Each save and boot runs in its own process, killed by the power cut. The flash is shared, so it survives like the real one.
+ */
+
+#include "sim_common.h"
+#include "settings_codec.h"
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Power cuts
+//-------------------------------------------------------------------------------------------------------------------------------
+// Each save stores a value in the settings and another one in the current tip
+static void setValue(int value, bool dirty){
+  tipData tip;
+
+  getTipData(systemSettings.Profile.currentTip, &tip);
+  tip.calADC_At_350 = 1000+value;
+  if(dirty){
+    setSettingsValue(contrast, value);
+  }
+  else{
+    systemSettings.settings.contrast = value;
+  }
+  setTipData(systemSettings.Profile.currentTip, &tip);
+}
+
+// Exits with 10 if the previous value is found, 11 if it's the new one
+static void childBootCheck(int expected){
+  tipData tip;
+
+  boot();
+  if(errorShown){
+    fprintf(stderr, "Error screen on boot\n");
+    exit(5);
+  }
+  int value = systemSettings.settings.contrast;
+  getTipData(systemSettings.Profile.currentTip, &tip);
+  if((value!=expected) && (value!=expected+1)){
+    fprintf(stderr, "Contrast %d, expected %d or %d\n", value, expected, expected+1);
+    exit(6);
+  }
+  if(tip.calADC_At_350 != 1000+value){
+    fprintf(stderr, "Tip calibration %u doesn't match the settings (%d)\n", tip.calADC_At_350, value);
+    exit(7);
+  }
+  exit((value==expected) ? 10 : 11);
+}
+
+static void childInit(int value){
+  boot();
+  systemSettings.settings.currentProfile = profile_T12;
+  loadProfile(profile_T12);
+  setValue(value, 0);
+  saveSettings(keepProfiles);
+}
+
+static void childSave(int value){
+  boot();
+  setValue(value, 0);
+  saveSettings(keepProfiles);
+}
+
+static void childBackgroundSave(int value){
+  boot();
+  setValue(value, 1);
+  hostElapse(60*1000000);                                           // Past the save delay
+  checkSettings();
+  finishSaving();
+}
+
+// Interrupt a save at every flash operation. Returns the number of power cuts
+static int testPowerCuts(const char *name, void (*save)(int), int *value){
+  int cuts=0;
+
+  for(long cut=0; ; cut++){
+    hostFlash->cutAt = cut;
+    hostFlash->ops = 0;
+    int saved = run(save, *value+1);
+    hostFlash->cutAt = -1;
+
+    int booted = run(childBootCheck, *value);
+    if((booted!=10) && (booted!=11)){
+      printf("FAIL: %s, power cut at flash operation %ld (Save exit %d, boot exit %d)\n", name, cut, saved, booted);
+      exit(1);
+    }
+    if(booted==11){
+      (*value)++;
+    }
+    if(saved==0){                                                   // Completed without being cut
+      if(booted!=11){
+        printf("FAIL: %s, the completed save was lost\n", name);
+        exit(1);
+      }
+      break;
+    }
+    if(saved!=HOST_POWER_CUT){
+      printf("FAIL: %s, save exit %d\n", name, saved);
+      exit(1);
+    }
+    cuts++;
+  }
+  printf("%-30s %5d power cuts, data always valid\n", name, cuts);
+  return cuts;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Iron timing
+//-------------------------------------------------------------------------------------------------------------------------------
+// Background save with the iron running. Exits with 8 if an ADC reading was delayed
+static void childWindow(int periodMs){
+  boot();
+  systemSettings.Profile.readPeriod = (periodMs*200)-1;
+  systemSettings.Profile.readDelay = (periodMs*20)-1;               // 10% of the period
+  Iron.Read_Timer = &readTimer;
+  setValue(periodMs, 1);
+  hostElapse(60*1000000);
+  checkSettings();
+  finishSaving();
+  printf("%3dmS read period:             %5u ADC readings delayed, %u flash operations with the iron stopped\n", periodMs, missedReadings, stoppedOps);
+  exit(missedReadings ? 8 : 0);
+}
+
+static void testWindow(int periodMs){
+  int saved = run(childWindow, periodMs);
+  int booted = run(childBootCheck, periodMs-1);
+
+  if(saved || (booted!=11)){
+    printf("FAIL: %dmS read period (Save exit %d, boot exit %d)\n", periodMs, saved, booted);
+    exit(1);
+  }
+}
+
+// Tips modified besides the current one: two are kept in RAM for the background save, the third one saves first
+#define QUEUE_TIPS      4
+
+static void queueTip(uint8_t x, tipData *tip){
+  getTipData(0, tip);
+  memcpy(tip->name, "TQ0", 4);
+  tip->name[2] += x;
+  tip->calADC_At_350 = 2000+x;
+  tip->PID.Kp = 5000+(x*300);
+}
+
+// Checks the tips in a mixed order, so the decoder has to go back and forth
+static void checkQueuedTips(void){
+  static const uint8_t order[] = { 3, 1, 2, 3, 2, 1 };
+
+  for(uint8_t x=0; x<sizeof(order); x++){
+    tipData tip, stored;
+
+    queueTip(order[x], &tip);
+    getTipData(order[x], &stored);
+    if(memcmp(&tip, &stored, sizeof(tipData))){
+      fprintf(stderr, "Tip %u doesn't match\n", order[x]);
+      exit(11);
+    }
+  }
+}
+
+static void childTipQueue(int arg){
+  tipData tip;
+
+  boot();
+  long ops = hostFlash->ops;
+  setProfileValue(currentNumberOfTips, QUEUE_TIPS);
+  for(uint8_t x=1; x<QUEUE_TIPS; x++){
+    queueTip(x, &tip);
+    setTipData(x, &tip);
+    if((x<QUEUE_TIPS-1) && (hostFlash->ops!=ops)){
+      fprintf(stderr, "Tip %u wasn't queued\n", x);
+      exit(9);
+    }
+  }
+  if(hostFlash->ops==ops){
+    fprintf(stderr, "No overlay left, the profile wasn't saved\n");
+    exit(10);
+  }
+  checkQueuedTips();
+  hostElapse(60*1000000);                                           // Background save, back to the first slot
+  checkSettings();
+  finishSaving();
+  checkQueuedTips();
+}
+
+// A tip not stored restarts the decoder, the next tip must be read from the start of the tips
+static void checkCursorRestart(void){
+  uint8_t profile = systemSettings.Profile.ID;
+  const uint8_t *data = (uint8_t*)flashSettings+flashSettings->ProfileOffset[profile];
+  uint16_t length = flashSettings->ProfileLength[profile];
+  tipCursor_t cursor = { .src = NULL };
+  tipData tip, expected;
+
+  decodeTip(&cursor, data, length, 2, &tip);                        // Cursor after the third tip
+  cursor.src = NULL;                                                // As if the data had changed
+  if(decodeTip(&cursor, data, length, QUEUE_TIPS, &tip)){
+    fprintf(stderr, "Decoded tip %u, it's not stored\n", QUEUE_TIPS);
+    exit(12);
+  }
+  getTipData(0, &expected);
+  if(!decodeTip(&cursor, data, length, 0, &tip) || memcmp(&tip, &expected, sizeof(tipData))){
+    fprintf(stderr, "Tip 0 doesn't match after a tip not stored\n");
+    exit(13);
+  }
+}
+
+static void childTipCheck(int arg){
+  boot();
+  checkQueuedTips();
+  checkCursorRestart();
+}
+
+static void testTipQueue(void){
+  int saved = run(childTipQueue, 0);
+  int booted = run(childTipCheck, 0);
+
+  if(saved || booted){
+    printf("FAIL: Tip queue (Save exit %d, boot exit %d)\n", saved, booted);
+    exit(1);
+  }
+  printf("Tip overlays:                  %d modified tips queued for the background save\n", QUEUE_TIPS-2);
+}
+
+// The current tip changes while the profile is being written, after the profile data and before the tip.
+// The save must store the tip it started with, matching the profile checksum
+static void childTipWhileSaving(int value){
+  tipData tip;
+  uint8_t last;
+
+  boot();
+  last = systemSettings.Profile.currentNumberOfTips-1;              // Encoded after the other tips
+  setProfileValue(currentTip, last);
+  setCurrentTip(last);
+  getTipData(last, &tip);
+  tip.calADC_At_350 = value;
+  setTipData(last, &tip);
+  hostElapse(60*1000000);
+  long programs = hostFlash->programs;
+  checkSettings();                                                  // Start the background save
+  while(hostFlash->programs==programs){
+    HAL_IWDG_Refresh(&hiwdg);
+    checkSettings();
+  }
+  tip.calADC_At_350 = value+1;
+  setTipData(last, &tip);
+  finishSaving();
+}
+
+// Exits with 10 if the tip has the value
+static void childTipValueCheck(int value){
+  tipData tip;
+
+  boot();
+  if(errorShown){
+    fprintf(stderr, "Error screen on boot\n");
+    exit(5);
+  }
+  getTipData(systemSettings.Profile.currentTip, &tip);
+  if(tip.calADC_At_350!=value){
+    fprintf(stderr, "Tip calibration %u, expected %d\n", tip.calADC_At_350, value);
+    exit(6);
+  }
+  exit(10);
+}
+
+static void testTipWhileSaving(void){
+  int saved = run(childTipWhileSaving, 1234);
+  int booted = run(childTipValueCheck, 1234);
+
+  if(saved || (booted!=10)){
+    printf("FAIL: Current tip changed while saving (Save exit %d, boot exit %d)\n", saved, booted);
+    exit(1);
+  }
+  printf("Current tip changed while saving: stored as it was when the save started\n");
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Images of the past versions
+//-------------------------------------------------------------------------------------------------------------------------------
+typedef struct{
+  uint8_t       id;
+  uint8_t       tips;
+  uint16_t      temperature;                                        // UserSetTemperature
+  uint16_t      cal[3];                                             // Default calibration
+}refProfile_t;
+
+static const refProfile_t refProfiles[] = {
+  { profile_T12,  3, 333, { 1100, 1200, 1300 } },
+  { profile_C245, 1, 300, { 900, 1000, 1100 } },
+};                                                                  // C210 not stored
+
+static uint8_t image[2048];
+
+static void put8(uint16_t offset, uint8_t value){ image[offset] = value; }
+static void put16(uint16_t offset, uint16_t value){ memcpy(&image[offset], &value, 2); }
+static void put32(uint16_t offset, uint32_t value){ memcpy(&image[offset], &value, 4); }
+
+// Values stored in all the images
+static void refSettings(settings_t *s){
+  memset(s, 0, sizeof(settings_t));
+  s->contrast = 77;
+  s->OledOffset = 3;
+  s->currentProfile = profile_T12;
+  s->saveSettingsDelay = 7;
+  s->initMode = mode_standby;
+  s->tempStep = 5;
+  s->screenDimming = 1;
+  s->activeDetection = 1;
+  s->buzzerMode = buzzer_On;
+  s->wakeOnButton = wakeButton_On;
+  s->StandMode = mode_standby;
+  s->errorDelay = 150;
+  s->guiUpdateDelay = 100;
+  s->lvp = 105;
+  s->version = SETTINGS_VERSION;
+}
+
+static void refProfile(const refProfile_t *ref, profile_t *p){
+  memset(p, 0, sizeof(profile_t));
+  p->ID = ref->id;
+  p->impedance = 80 + ref->id;
+  p->currentNumberOfTips = ref->tips;
+  p->currentTip = ref->tips-1;
+  p->filterFactor = 3;
+  p->CalNTC = -3;
+  p->sleepTimeout = 4;
+  p->standbyTimeout = 6;
+  p->standbyTemperature = 150;
+  p->UserSetTemperature = ref->temperature;
+  p->MaxSetTemperature = 450;
+  p->MinSetTemperature = 180;
+  p->pwmMul = 1;
+  p->readPeriod = 39999;
+  p->readDelay = 3999;
+  p->noIronValue = 4000-ref->id;
+  p->power = 80;
+  p->Cal250_default = ref->cal[0];
+  p->Cal350_default = ref->cal[1];
+  p->Cal450_default = ref->cal[2];
+}
+
+static void refTip(const refProfile_t *ref, uint8_t tip, tipData *t){
+  memset(t, 0, sizeof(tipData));
+  memcpy(t->name, "T0-0", TipCharSize);
+  t->name[1] += ref->id;
+  t->name[3] += tip;
+  t->calADC_At_250 = ref->cal[0]-50+(tip*7);
+  t->calADC_At_350 = ref->cal[1]+tip;
+  t->calADC_At_450 = ref->cal[2]+40-(tip*2);
+  t->PID.Kp = 7500+(tip*100);
+  t->PID.Ki = 4000;
+  t->PID.Kd = 1000-tip;
+  t->PID.tau = 10;
+  t->PID.maxI = 40;
+  t->PID.minI = -2-tip;
+}
+
+static void buildSettings(uint16_t offset, uint32_t version){
+  settings_t s;
+
+  refSettings(&s);
+  put8(offset+0, s.NotInitialized);
+  put8(offset+1, s.contrast);
+  put8(offset+2, s.OledOffset);
+  put8(offset+3, s.currentProfile);
+  put8(offset+4, s.saveSettingsDelay);
+  put8(offset+5, s.initMode);
+  put8(offset+6, s.tempStep);
+  put8(offset+7, s.screenDimming);
+  put8(offset+8, s.tempUnit);
+  put8(offset+9, s.activeDetection);
+  put8(offset+10, s.buzzerMode);
+  put8(offset+11, s.wakeOnButton);
+  put8(offset+12, s.wakeOnShake);
+  put8(offset+13, s.WakeInputMode);
+  put8(offset+14, s.StandMode);
+  put8(offset+15, s.EncoderMode);
+  put16(offset+16, s.errorDelay);
+  put16(offset+18, s.guiUpdateDelay);
+  put16(offset+20, s.lvp);
+  put32(offset+24, version);
+  put32(offset+28, ChecksumBlock(&image[offset], 28));             // Checksum follows the settings
+}
+
+// v5: Stored in the last 2KB, now the second slot. Three 274 byte profiles with 10 tips, profile checksums at 824, settings at 836. Word checksums
+static void buildV5(void){
+  memset(image, 0xFF, sizeof(image));
+  for(uint8_t x=0; x<sizeof(refProfiles)/sizeof(refProfiles[0]); x++){
+    const refProfile_t *ref = &refProfiles[x];
+    uint16_t offset = ref->id*274;
+    profile_t p;
+
+    refProfile(ref, &p);
+    memset(&image[offset], 0, 274);
+    put8(offset+0, p.NotInitialized);
+    put8(offset+1, p.ID);
+    put8(offset+2, p.impedance);
+    put8(offset+3, p.tempUnit);
+    put8(offset+4, p.currentNumberOfTips);
+    put8(offset+5, p.currentTip);
+    put8(offset+6, p.filterFactor);
+    put8(offset+7, p.CalNTC);
+    put8(offset+8, p.sleepTimeout);
+    put8(offset+9, p.standbyTimeout);
+    put8(offset+10, p.standbyTemperature);
+    put16(offset+12, p.UserSetTemperature);
+    put16(offset+14, p.MaxSetTemperature);
+    put16(offset+16, p.MinSetTemperature);
+    put16(offset+18, p.pwmMul);
+    put16(offset+20, p.readPeriod);
+    put16(offset+22, p.readDelay);
+    put16(offset+24, p.noIronValue);
+    put16(offset+26, p.power);
+    put16(offset+28, p.Cal250_default);
+    put16(offset+30, p.Cal350_default);
+    put16(offset+32, p.Cal450_default);
+    for(uint8_t t=0; t<10; t++){
+      uint16_t tip = offset+34+(t*24);
+      tipData d;
+
+      if(t<ref->tips){
+        refTip(ref, t, &d);
+      }
+      else{
+        memset(&d, 0, sizeof(tipData));
+        strcpy(d.name, _BLANK_TIP);
+      }
+      put16(tip+0, d.calADC_At_250);
+      put16(tip+2, d.calADC_At_350);
+      put16(tip+4, d.calADC_At_450);
+      memcpy(&image[tip+6], d.name, 5);
+      put16(tip+12, d.PID.Kp);
+      put16(tip+14, d.PID.Ki);
+      put16(tip+16, d.PID.Kd);
+      put16(tip+18, d.PID.tau);
+      put16(tip+20, d.PID.maxI);
+      put16(tip+22, d.PID.minI);
+    }
+    put32(824+(ref->id*4), ChecksumBlock(&image[offset], 272));
+  }
+  buildSettings(836, 5);
+  hostFlashLoad(image, (StoreSize*1024)-sizeof(image), sizeof(image));
+}
+
+// v5 with a bad settings checksum
+static void buildV5BadSettings(void){
+  buildV5();
+  put32(836+28, ~ChecksumBlock(&image[836], 28));
+  hostFlashLoad(image, (StoreSize*1024)-sizeof(image), sizeof(image));
+}
+
+static void checkProfiles(int version){
+  profile_t profile;
+  tipData tip, stored;
+
+  for(uint8_t x=0; x<sizeof(refProfiles)/sizeof(refProfiles[0]); x++){
+    const refProfile_t *ref = &refProfiles[x];
+
+    loadProfile(ref->id);
+    refProfile(ref, &profile);
+    if(errorShown || memcmp(&profile, &systemSettings.Profile, sizeof(profile_t))){
+      fprintf(stderr, "v%d: Profile %u doesn't match\n", version, ref->id);
+      exit(7);
+    }
+    for(uint8_t t=0; t<TipSize; t++){
+      if(t<ref->tips){
+        refTip(ref, t, &tip);
+      }
+      else{
+        memset(&tip, 0, sizeof(tipData));
+        strcpy(tip.name, _BLANK_TIP);
+      }
+      getTipData(t, &stored);
+      if(memcmp(&tip, &stored, sizeof(tipData))){
+        fprintf(stderr, "v%d: Profile %u tip %u doesn't match\n", version, ref->id, t);
+        exit(8);
+      }
+    }
+  }
+}
+
+enum{
+  settings_Kept,
+  settings_Lost,                                                    // Settings not converted, shown as a settings error and reset. The profiles are kept
+  settings_Reset,                                                   // Next boot after settings_Lost
+};
+
+// Check all the values were kept, and the data is stored with the current version
+static void childMigrationCheck(int settings){
+  settings_t ref;
+
+  boot();
+  if(errorShown != (settings==settings_Lost)){
+    fprintf(stderr, "v5: %s\n", errorShown ? "Error screen on boot" : "No settings error shown");
+    exit(5);
+  }
+  errorShown = 0;
+  refSettings(&ref);
+  if( (!memcmp(&ref, &systemSettings.settings, sizeof(settings_t)) != (settings==settings_Kept)) || (flashSettings->settings.version!=SETTINGS_VERSION) ){
+    fprintf(stderr, "v5: Settings don't match\n");
+    exit(6);
+  }
+  checkProfiles(5);
+}
+
+static void testMigration(const char *name, void (*build)(void), bool badSettings){
+  hostFlashInit();
+  build();
+  int converted = run(childMigrationCheck, badSettings ? settings_Lost : settings_Kept);
+  uint32_t erases = hostFlash->erases;
+  int reloaded = run(childMigrationCheck, badSettings ? settings_Reset : settings_Kept);   // Already converted, must load without writing
+
+  if(converted || reloaded || (erases != hostFlash->erases)){
+    printf("FAIL: %s (Exit %d, after reboot %d)\n", name, converted, reloaded);
+    exit(1);
+  }
+  printf("%-30s converted, %s\n", name, badSettings ? "settings error shown, profiles kept" : "all the values kept");
+}
+
+int main(void){
+  int value=1;
+
+  hostFlashInit();
+  if(run(childInit, value)){
+    printf("FAIL: Initial save\n");
+    return 1;
+  }
+  testPowerCuts("Blocking save:", childSave, &value);
+  testPowerCuts("Background save:", childBackgroundSave, &value);
+  testWindow(200);
+  testWindow(10);
+  testTipQueue();
+  testTipWhileSaving();
+  testMigration("v5 image:", buildV5, 0);
+  testMigration("v5 image, bad settings:", buildV5BadSettings, 1);
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * sim_common.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Firmware functions used by settings.c, and the read timer emulation.
+ */
+
+#include "sim_common.h"
+#include <sys/wait.h>
+#include <unistd.h>
+
+volatile ADC_Status_t ADC_Status;
+volatile iron_t Iron;
+oled_t oled;
+u8g2_t u8g2;
+GPIO_TypeDef *GPIOA, *GPIOB, *GPIOC;
+
+static TIM_TypeDef readTimerRegs;
+TIM_HandleTypeDef readTimer = { &readTimerRegs };
+static uint32_t timerUs;
+uint32_t missedReadings;
+uint32_t stoppedOps;
+bool errorShown;
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Firmware functions used by settings.c
+//-------------------------------------------------------------------------------------------------------------------------------
+void _Error_Handler(char *file, int line){
+  fprintf(stderr, "Error_Handler %s:%d\n", file, line);
+  exit(3);
+}
+void NVIC_SystemReset(void){ exit(0); }
+void configurePWMpin(uint8_t mode){}
+void setContrast(uint8_t value){}
+void setCurrentTip(uint8_t tip){ selectTip(tip); }
+void setSafeMode(bool mode){}
+void setSystemTempUnit(bool unit){}
+void setUserTemperature(uint16_t temperature){}
+void update_display(void){}
+void FillBuffer(bool color, bool mode){ errorShown = 1; }
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin){ return GPIO_PIN_SET; }       // Button not pressed
+void putStrAligned(char* str, uint8_t y, AlignType align){
+  fprintf(stderr, "  Screen: %s\n", str);
+  if(!strcmp(str, "FLASH ERROR!")){
+    exit(4);
+  }
+}
+void u8g2_SetDrawColor(u8g2_t *u8g2, uint8_t color){}
+void u8g2_SetFont(u8g2_t *u8g2, const uint8_t *font){}
+void u8g2_DrawBox(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h){}
+u8g2_uint_t u8g2_DrawStr(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, const char *str){ return 0; }
+u8g2_uint_t u8g2_GetStrWidth(u8g2_t *u8g2, const char *str){ return 0; }
+
+// Read timer, 5uS ticks. Only the PWM part of the period is emulated, the ADC reading is instantaneous
+void hostOnElapse(uint32_t us){
+  if(Iron.Read_Timer==NULL){
+    return;
+  }
+  uint32_t window = systemSettings.Profile.readPeriod-(systemSettings.Profile.readDelay+1);
+
+  if(hostFlash->busy && systemSettings.isSaving){
+    stoppedOps++;
+  }
+  timerUs += us;
+  readTimerRegs.CNT += timerUs/5;
+  timerUs %= 5;
+  if(readTimerRegs.CNT >= window){                                  // Readings done while this time elapsed
+    if(hostFlash->busy && !systemSettings.isSaving){
+      missedReadings += readTimerRegs.CNT/window;
+    }
+    readTimerRegs.CNT %= window;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+// Helpers
+//-------------------------------------------------------------------------------------------------------------------------------
+// Run fn in a new process, returns its exit code
+int run(void (*fn)(int), int arg){
+  int status;
+
+  fflush(stdout);
+  fflush(stderr);
+  pid_t pid = fork();
+  if(!pid){
+    fn(arg);
+    exit(0);
+  }
+  waitpid(pid, &status, 0);
+  return WEXITSTATUS(status);
+}
+
+void boot(void){
+  memset(&systemSettings, 0, sizeof(systemSettings));
+  Iron.Read_Timer = NULL;
+  errorShown = 0;
+  restoreSettings();
+}
@@ -0,0 +1,27 @@
+/*
+ * sim_common.h
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Firmware functions and helpers shared by the settings host tools (settings_sim, settings_bench).
+ */
+
+#ifndef SIM_COMMON_H_
+#define SIM_COMMON_H_
+
+#include "hal_host.h"
+#include "iron.h"
+#include "gui.h"
+#include "ssd1306.h"
+#include "adc_global.h"
+
+extern TIM_HandleTypeDef readTimer;
+extern uint32_t missedReadings;                                     // Readings delayed by a flash operation with the iron running
+extern uint32_t stoppedOps;                                         // Flash operations done with the iron stopped
+extern bool errorShown;
+
+int run(void (*fn)(int), int arg);
+void boot(void);
+
+#endif /* SIM_COMMON_H_ */
@@ -0,0 +1,203 @@
+/*
+ * xbm2page.c
+ *
+ *  Created on: Jul 24, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ *
+ *  Converts XBM images to the display page format used by drawBitmap() (Drivers/graphics/bitmap.h).
+ *
+ *  Usage: xbm2page [-r] [-o name] file.xbm...
+ *    -r        Compress with RLE (Only used if smaller)
+ *    -o name   Write name.c and name.h, otherwise the arrays are printed to stdout
+ *
+ *  Each image is stored as "<xbm name>BMP": width, height, flags, data.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define BITMAP_RLE      0x01
+#define MAX_SIZE        (255*32)
+
+typedef struct{
+  char      name[64];
+  int       width;
+  int       height;
+  int       flags;
+  int       size;
+  uint8_t   data[MAX_SIZE*2];
+}bitmap_t;
+
+static int readXBM(const char *file, bitmap_t *bmp){
+  static char text[256*1024];
+  uint8_t xbm[MAX_SIZE];
+  int len, count=0;
+  char *p;
+  FILE *f = fopen(file, "r");
+
+  if(!f){
+    fprintf(stderr, "Can't open %s\n", file);
+    return 0;
+  }
+  len = fread(text, 1, sizeof(text)-1, f);
+  fclose(f);
+  text[len] = 0;
+
+  memset(bmp, 0, sizeof(bitmap_t));
+  p = strstr(text, "_width");
+  if(!p || sscanf(p, "_width %d", &bmp->width)!=1 || !(p=strstr(text, "_height")) || sscanf(p, "_height %d", &bmp->height)!=1){
+    fprintf(stderr, "%s: width or height not found\n", file);
+    return 0;
+  }
+  p = strstr(text, "#define");                                  // Name from "#define <name>_width"
+  if(p){
+    sscanf(p, "#define %63[A-Za-z0-9_]", bmp->name);
+    char *end = strstr(bmp->name, "_width");
+    if(end){
+      *end = 0;
+    }
+  }
+  if(bmp->width<1 || bmp->width>255 || bmp->height<1 || bmp->height>255){
+    fprintf(stderr, "%s: wrong size %dx%d\n", file, bmp->width, bmp->height);
+    return 0;
+  }
+  p = strchr(text, '{');
+  while(p && count<MAX_SIZE){
+    p = strstr(p, "0x");
+    if(!p){
+      break;
+    }
+    xbm[count++] = strtol(p, &p, 16);
+  }
+  int stride = (bmp->width+7)/8;
+  if(count < stride*bmp->height){
+    fprintf(stderr, "%s: not enough data\n", file);
+    return 0;
+  }
+
+  int pages = (bmp->height+7)/8;                                // XBM: rows of horizontal bytes, LSB first. Page format: columns of 8 rows, LSB on top
+  for(int page=0; page<pages; page++){
+    for(int x=0; x<bmp->width; x++){
+      uint8_t data = 0;
+      for(int bit=0; bit<8; bit++){
+        int y = (page*8)+bit;
+        if(y<bmp->height && (xbm[(y*stride)+(x/8)] & (1<<(x&7)))){
+          data |= 1<<bit;
+        }
+      }
+      bmp->data[bmp->size++] = data;
+    }
+  }
+  return 1;
+}
+
+// Control byte n<128: n+1 literal bytes follow. n>=128: The next byte is repeated n-126 times
+static int compress(const uint8_t *src, int len, uint8_t *dst){
+  int out=0, i=0;
+
+  while(i<len){
+    int run=1;
+    while(i+run<len && src[i+run]==src[i] && run<129){
+      run++;
+    }
+    if(run>=3){
+      dst[out++] = run+126;
+      dst[out++] = src[i];
+      i += run;
+      continue;
+    }
+    int lit=0;                                                  // Literal block until the next run of 3
+    while(i+lit<len && lit<128){
+      if(i+lit+2<len && src[i+lit]==src[i+lit+1] && src[i+lit]==src[i+lit+2]){
+        break;
+      }
+      lit++;
+    }
+    dst[out++] = lit-1;
+    memcpy(&dst[out], &src[i], lit);
+    out += lit;
+    i += lit;
+  }
+  return out;
+}
+
+static void writeBitmap(FILE *f, bitmap_t *bmp){
+  fprintf(f, "const uint8_t %sBMP[] = {\n  %d, %d, %s,", bmp->name, bmp->width, bmp->height, (bmp->flags&BITMAP_RLE) ? "BITMAP_RLE" : "0");
+  for(int x=0; x<bmp->size; x++){
+    fprintf(f, "%s0x%02X,", (x%12) ? " " : "\n  ", bmp->data[x]);
+  }
+  fprintf(f, " };\n\n");
+}
+
+int main(int argc, char **argv){
+  static bitmap_t bmp;
+  uint8_t rle[MAX_SIZE*2];
+  const char *out = NULL;
+  int useRLE=0, first=1;
+  FILE *c=stdout, *h=NULL;
+
+  for(first=1; first<argc && argv[first][0]=='-'; first++){
+    if(!strcmp(argv[first], "-r")){
+      useRLE = 1;
+    }
+    else if(!strcmp(argv[first], "-o") && first+1<argc){
+      out = argv[++first];
+    }
+    else{
+      first = argc;
+    }
+  }
+  if(first>=argc){
+    fprintf(stderr, "Usage: xbm2page [-r] [-o name] file.xbm...\n");
+    return 1;
+  }
+  if(out){
+    char file[256];
+    const char *base = strrchr(out, '/') ? strrchr(out, '/')+1 : out;
+    snprintf(file, sizeof(file), "%s.c", out);
+    c = fopen(file, "w");
+    snprintf(file, sizeof(file), "%s.h", out);
+    h = fopen(file, "w");
+    if(!c || !h){
+      fprintf(stderr, "Can't create %s.c/.h\n", out);
+      return 1;
+    }
+    char guard[128];
+    int n=0;
+    for(const char *p=base; *p && n<100; p++){
+      guard[n++] = toupper((unsigned char)*p);
+    }
+    guard[n] = 0;
+    fprintf(c, "/*\n * %s.c\n *\n *  Generated by xbm2page, don't edit. Source images in u8g2/tools/xbm2page/assets\n */\n\n#include \"%s.h\"\n\n", base, base);
+    fprintf(h, "/*\n * %s.h\n *\n *  Generated by xbm2page, don't edit. Source images in u8g2/tools/xbm2page/assets\n */\n\n", base);
+    fprintf(h, "#ifndef GRAPHICS_GUI_%s_H_\n#define GRAPHICS_GUI_%s_H_\n\n#include \"bitmap.h\"\n\n", guard, guard);
+  }
+  for(int x=first; x<argc; x++){
+    if(!readXBM(argv[x], &bmp)){
+      return 1;
+    }
+    int xbmSize = ((bmp.width+7)/8)*bmp.height;
+    if(useRLE){
+      int size = compress(bmp.data, bmp.size, rle);
+      if(size<bmp.size){
+        memcpy(bmp.data, rle, size);
+        bmp.size = size;
+        bmp.flags |= BITMAP_RLE;
+      }
+    }
+    fprintf(stderr, "%s: %dx%d, %d bytes (XBM %d)%s\n", bmp.name, bmp.width, bmp.height, bmp.size+3, xbmSize+2, (bmp.flags&BITMAP_RLE) ? " RLE" : "");
+    writeBitmap(c, &bmp);
+    if(h){
+      fprintf(h, "extern const uint8_t %sBMP[];\n", bmp.name);
+    }
+  }
+  if(h){
+    fprintf(h, "\n#endif\n");
+    fclose(h);
+    fclose(c);
+  }
+  return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * width_cache.c
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#include "width_cache.h"
+
+/*
+ * u8g2_GetStrWidth searches every glyph in the font data, each time the string is aligned.
+ * The menus align the same labels and options on every frame, so the widths are cached by font and string pointer.
+ * The string buffers are reused with different text, so a hash of the text is also stored, and checked before using the width.
+ * Hashing is just a pass over the characters, much faster than the font search. When full, the oldest entry is replaced.
+ */
+
+typedef struct{
+  const uint8_t   *font;                                        // NULL if empty
+  const char      *str;
+  uint32_t        hash;
+  u8g2_uint_t     width;
+}strWidth_t;
+
+static strWidth_t cache[WIDTH_CACHE_ENTRIES];
+static uint8_t next;
+
+// FNV-1a
+static uint32_t strHash(const char *str){
+  uint32_t hash = 2166136261UL;
+  while(*str){
+    hash = (hash ^ (uint8_t)*str++) * 16777619UL;
+  }
+  return hash;
+}
+
+// Same as u8g2_GetStrWidth, cached
+u8g2_uint_t cachedStrWidth(u8g2_t *u8g2, const char *str){
+  strWidth_t *entry = NULL;
+  uint32_t hash = strHash(str);
+
+  for(uint8_t x=0; x<WIDTH_CACHE_ENTRIES; x++){
+    if(cache[x].font==u8g2->font && cache[x].str==str){
+      if(cache[x].hash==hash){
+        return cache[x].width;
+      }
+      entry = &cache[x];                                        // Same buffer, text changed
+      break;
+    }
+  }
+  if(!entry){
+    entry = &cache[next];
+    if(++next>=WIDTH_CACHE_ENTRIES){
+      next = 0;
+    }
+    entry->font = u8g2->font;
+    entry->str = str;
+  }
+  entry->hash = hash;
+  entry->width = u8g2_GetStrWidth(u8g2, str);
+  return entry->width;
+}
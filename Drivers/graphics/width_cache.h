@@ -0,0 +1,18 @@
+/*
+ * width_cache.h
+ *
+ *  Created on: Jul 26, 2021
+ *      Author: David    Original work by Jose (PTDreamer), 2017
+ */
+
+#ifndef GRAPHICS_WIDTH_CACHE_H_
+#define GRAPHICS_WIDTH_CACHE_H_
+
+#include "u8g2.h"
+#include "main.h"
+
+#define WIDTH_CACHE_ENTRIES   16                                // Cached string widths, 16 bytes each
+
+u8g2_uint_t cachedStrWidth(u8g2_t *u8g2, const char *str);
+
+#endif /* GRAPHICS_WIDTH_CACHE_H_ */